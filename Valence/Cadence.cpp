@@ -0,0 +1,84 @@
+#include "Cadence.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+
+/* Sleeps wake on the system timer, which ticks every 15.6 ms by default
+* asks for 1 ms ticks while the process runs
+*/
+struct TimerResolution {
+	TimerResolution() { timeBeginPeriod(1); }
+	~TimerResolution() { timeEndPeriod(1); }
+};
+#endif
+
+const double Cadence::UNTHROTTLED = -1;
+
+//longest yield before a deadline, a sleep waking up later than this makes the tick late instead
+static const std::chrono::microseconds MAX_SPIN(1000);
+//how long a paused loop naps before it looks again
+static const std::chrono::milliseconds PAUSE_NAP(10);
+//ticks a loop may fall behind before the missed ones are dropped
+static const int MAX_BEHIND = 4;
+
+Cadence::Cadence(double rate) {
+#ifdef _WIN32
+	static TimerResolution resolution;
+#endif
+	this->rate = 0;
+	this->wakeLate = clock::duration::zero();
+	this->period = clock::duration::zero();
+	this->deadline = clock::now();
+	this->setRate(rate);
+}
+
+void Cadence::setRate(double rate) {
+	if (rate == this->rate) {
+		return;
+	}
+	this->rate = rate;
+	this->period = clock::duration::zero();
+	if (rate > 0) {
+		this->period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate));
+	}
+	this->deadline = clock::now() + this->period;
+}
+
+double Cadence::getRate() const {
+	return this->rate;
+}
+
+bool Cadence::wait() {
+	if (this->rate < 0) {
+		return true;
+	}
+	if (this->rate == 0) {
+		std::this_thread::sleep_for(PAUSE_NAP);
+		return false;
+	}
+	clock::time_point now = clock::now();
+	if (now - this->deadline > this->period * MAX_BEHIND) {
+		this->deadline = now;
+	}
+	//never yield for more than half a tick, so every tick sleeps and keeps measuring its wake ups
+	clock::duration spin = std::min<clock::duration>(this->wakeLate, this->period / 2);
+	if (this->deadline - now > spin) {
+		clock::time_point wake = this->deadline - spin;
+		std::this_thread::sleep_until(wake);
+		//move halfway towards a later wake up and back slowly, a rare slow one should not make every tick spin
+		clock::duration late = std::max(clock::now() - wake, clock::duration::zero());
+		this->wakeLate += late > this->wakeLate ? (late - this->wakeLate) / 2 : (late - this->wakeLate) / 8;
+		this->wakeLate = std::min<clock::duration>(this->wakeLate, MAX_SPIN);
+	}
+	while (clock::now() < this->deadline) {
+		std::this_thread::yield();
+	}
+	this->deadline += this->period;
+	return true;
+}
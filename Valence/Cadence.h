@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+
+/*
+* Paces a loop at a fixed rate of ticks per second
+*
+* Ticks are scheduled a whole period after the previous deadline rather than after
+* whenever the last tick finished, so the rate does not drift with the time spent working.
+* A loop that falls far behind gives up on the missed ticks instead of rushing to catch up.
+* Waiting sleeps until just before the deadline and yields for the rest, no longer than
+* sleeping has lately been waking up late.
+*
+* Not thread safe, owned by the loop it paces.
+*/
+class Cadence {
+	typedef std::chrono::steady_clock clock;
+
+	double rate; //ticks per second, 0 paused, negative as fast as possible
+	clock::duration period;
+	clock::time_point deadline;
+	clock::duration wakeLate; //how late sleeps have been waking up, the time yielded before each deadline
+
+public:
+	static const double UNTHROTTLED; //any negative rate
+
+	/* @param rate ticks per second, 0 to pause and UNTHROTTLED to never wait
+	*/
+	Cadence(double rate);
+
+	/* Changes the rate, the next tick is a whole new period away
+	* setting the current rate again keeps the cadence as it is
+	*/
+	void setRate(double rate);
+	double getRate() const;
+
+	/* Waits until the next tick is due and returns true
+	* returns false after a short nap while paused so the caller can check on its loop
+	*/
+	bool wait();
+};
@@ -1,16 +1,19 @@
 #include "Config.h"
 #include "GameEngine.h"
-#include <thread>
+#include "Instrumentation.h"
 
-GameEngine::GameEngine() {
+GameEngine::GameEngine(int universeWidth, int universeHeight, const std::string& replayPath) : updateCadence(0), renderCadence(MAX_FPS) {
+	this->universeWidth = universeWidth;
+	this->universeHeight = universeHeight;
+	this->replayPath = replayPath;
 	initPreSDL();
 	initSDL();
 	initPostSDL();
 }
 
 void GameEngine::initPreSDL() {
-	srand(time(NULL));
 	UPS_CHOICE = 1;
+	paused = false;
 	totalFrames = 0;
 	totalUpdates = 0;
 	startTime = std::chrono::steady_clock::now();
@@ -46,55 +49,109 @@ void GameEngine::initSDL() {
 	}
 }
 void GameEngine::initPostSDL() {
-	universe = new Universe(UNIVERSE_SIZE);
+	universe = nullptr;
+	replay = nullptr;
+	if (!replayPath.empty()) {
+		replay = new TrajectoryReader(replayPath);
+		if (!replay->isOpen()) {
+			delete replay;
+			replay = nullptr;
+		}
+	}
+	if (replay == nullptr) {
+		universe = new Universe(universeWidth, universeHeight, randomSeed());
+	}
+	renderer = new UniverseRenderer();
+	resetRequested = false;
+	saveRequested = false;
+	loadRequested = false;
 	isRunning = true;
+	this->publishSnapshot();
+	snapshotOwed = false;
 }
 
 int GameEngine::updateGame(void* self) {
 	GameEngine* g = (GameEngine*)self;
 	while (g->isRunning) {
-		if (g->updateRequired()) {
-			g->update();
-		}
+		g->updateCadence.setRate(g->paused ? 0 : UPS[g->UPS_CHOICE]);
+		g->update(g->updateCadence.wait());
 	}
 	return 0;
 }
-bool GameEngine::updateRequired() {
-	using namespace std::chrono_literals;
-	std::chrono::milliseconds duration;
-	duration = std::chrono::milliseconds(1000 / UPS[UPS_CHOICE]) - std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastUpdate);
-	if (duration < 1ms) {
-		lastUpdate = std::chrono::steady_clock::now();
-		return true;
+
+void GameEngine::update(bool step) {
+	if (this->replay != nullptr) {
+		//a left click starts the recording over, the rate keys set how fast it plays
+		if (this->resetRequested.exchange(false)) {
+			this->replay->seek(this->replay->firstStep());
+			this->snapshotOwed = true;
+		}
+		else if (step && this->replay->step()) {
+			totalUpdates++;
+			this->snapshotOwed = true;
+		}
 	}
-	else {
-		std::this_thread::sleep_for(duration);
-		return false;
+	else if (this->resetRequested.exchange(false)) {
+		delete this->universe;
+		this->universe = new Universe(this->universeWidth, this->universeHeight, randomSeed());
+		this->snapshotOwed = true;
+	}
+	else if (this->saveRequested.exchange(false)) {
+		this->universe->saveCheckpoint(CHECKPOINT_FILE);
+	}
+	else if (this->loadRequested.exchange(false)) {
+		Universe* loaded = Universe::openCheckpoint(CHECKPOINT_FILE);
+		if (loaded != nullptr) {
+			delete this->universe;
+			this->universe = loaded;
+			//a reset keeps the size of the universe on screen
+			this->universeWidth = loaded->width();
+			this->universeHeight = loaded->height();
+			this->snapshotOwed = true;
+		}
+	}
+	else if (step) {
+		totalUpdates++;
+		universe->update();
+		this->snapshotOwed = true;
+	}
+	//fast rates outrun the screen, skip copying updates the renderer would never show
+	if (this->snapshotOwed && !this->snapshots.pending()) {
+		this->publishSnapshot();
+		this->snapshotOwed = false;
 	}
 }
 
-void GameEngine::update() {
-	totalUpdates++;
-	universe->update();
+void GameEngine::publishSnapshot() {
+	RenderSnapshot& snapshot = this->snapshots.writeBuffer();
+	if (this->replay != nullptr) {
+		this->replay->writeSnapshot(snapshot);
+	}
+	else {
+		this->universe->writeSnapshot(snapshot);
+	}
+	snapshot.buildLevels();
+	this->snapshots.publish();
 }
 
 int GameEngine::renderGame(void* self) {
 	GameEngine* g = (GameEngine*)self;
 	while (g->isRunning) {
-		if (g->renderRequired()) {
+		if (g->renderCadence.wait()) {
 			g->render();
 		}
 	}
 	return 0;
 }
 
-bool GameEngine::renderRequired() {
-	return true;
-}
 void GameEngine::render() {
 	totalFrames++;
 	SDL_RenderClear(ren);
-	universe->draw(ren);
+	{
+		PhaseClock clock(PT_DRAW);
+		renderer->draw(ren, this->snapshots.latest());
+	}
+	PhaseClock clock(PT_PRESENT);
 	SDL_RenderPresent(ren);
 }
 
@@ -102,12 +159,10 @@ void GameEngine::handleEvent(SDL_Event e) {
 	static SDL_Point mousePoint;
 	mousePoint.x = e.motion.x;
 	mousePoint.y = e.motion.y;
-	universe->handleEvent(e, mousePoint);
+	renderer->handleEvent(e, mousePoint);
 	if (e.type == SDL_MOUSEBUTTONDOWN) {
 		if (e.button.button == SDL_BUTTON_LEFT) {
-			Universe* temp = this->universe;
-			this->universe = new Universe(UNIVERSE_SIZE);
-			delete temp;
+			this->resetRequested = true;
 		}
 	}
 	else if (e.type == SDL_KEYDOWN) {
@@ -115,8 +170,18 @@ void GameEngine::handleEvent(SDL_Event e) {
 		for (int i = 0; i < 10; i++) {
 			if (e.key.keysym.sym == updateRateMap[i]) {
 				this->UPS_CHOICE = i;
+				this->paused = false;
 			}
 		}
+		if (e.key.keysym.sym == SDLK_SPACE) {
+			this->paused = !this->paused;
+		}
+		if (e.key.keysym.sym == SDLK_F5) {
+			this->saveRequested = true;
+		}
+		if (e.key.keysym.sym == SDLK_F9) {
+			this->loadRequested = true;
+		}
 	}
 }
 
@@ -128,7 +193,8 @@ void GameEngine::run() {
 	renderThread = SDL_CreateThread(renderGame, "Render", this);
 	while (isRunning) {
 		SDL_Event sdlEvent;
-		while (SDL_PollEvent(&sdlEvent)) {
+		//sleep until something happens instead of spinning, waking now and then to notice a quit
+		if (SDL_WaitEventTimeout(&sdlEvent, 100)) {
 			//if the window was closed, close the game
 			if (sdlEvent.type == SDL_WINDOWEVENT) {
 				if (sdlEvent.window.event == SDL_WINDOWEVENT_CLOSE) {
@@ -139,11 +205,15 @@ void GameEngine::run() {
 			handleEvent(sdlEvent);
 		}
 	}
-	//give me some info before you're done
-	std::cout << "FRAMES: " << totalFrames << " FPS: " << (totalFrames * 1000) / ((std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count())) << std::endl;
-	std::cout << "Total Updates: " << totalUpdates << std::endl;
 	SDL_WaitThread(updateThread, &updateResult);
 	SDL_WaitThread(renderThread, &drawResult);
+	//give me some info before you're done
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "FRAMES: " << totalFrames << " FPS: " << totalFrames / seconds << std::endl;
+	std::cout << "Total Updates: " << totalUpdates << " UPS: " << totalUpdates / seconds << std::endl;
+	if (INSTRUMENT) {
+		Instrumentation::writeJson(std::cout, totalUpdates, instruments().sample());
+	}
 	quit();
 }
 
@@ -6,48 +6,69 @@
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
 #include <chrono>
+#include <atomic>
 
+#include "Config.h"
 #include "Universe.h"
+#include "Trajectory.h"
+#include "UniverseRenderer.h"
+#include "Cadence.h"
 
 typedef std::chrono::steady_clock::time_point time_point;
-typedef std::chrono::milliseconds millis;
 
 class GameEngine {
-	int UPS_CHOICE;
+	std::atomic<int> UPS_CHOICE;
+	std::atomic<bool> paused;
 	size_t totalFrames;
 	size_t totalUpdates;
 	time_point startTime;
 	
 	int screenWidth;
 	int screenHeight;
+	int universeWidth;
+	int universeHeight;
 
-	bool isRunning;
+	std::atomic<bool> isRunning;
+	std::atomic<bool> resetRequested; //a new universe is created on the update thread, which owns it
+	std::atomic<bool> saveRequested;  //checkpoints are saved and loaded on the update thread as well
+	std::atomic<bool> loadRequested;
 
-	Universe* universe;
+	Universe* universe; //only touched by the update thread once the threads run
+	TrajectoryReader* replay; //plays a recorded trajectory instead of running the universe, nullptr when live
+	std::string replayPath;
+	UniverseRenderer* renderer;
+	SnapshotExchange snapshots; //finished updates handed from the update thread to the render thread
+	bool snapshotOwed;          //the universe changed since the last published snapshot
+
+	Cadence updateCadence; //paces the update thread at UPS[UPS_CHOICE]
+	Cadence renderCadence; //caps the render thread at MAX_FPS
 
-	SDL_mutex* updateMute, * renderMute;
 	SDL_Thread* updateThread, * renderThread;
 	SDL_Window* window;
 	SDL_Renderer* ren;
 
-	time_point lastUpdate, lastRender;
-	millis currentTime;
 	void initPreSDL();
 	void initSDL();
 	void initPostSDL();
 
 	static int updateGame(void* self);
-	bool updateRequired();
-	void update();
+
+	/* Applies a pending reset, save or load or steps the universe, then publishes a snapshot when the renderer is ready for one
+	* @param step whether the update cadence is due, requests are applied even while paused
+	*/
+	void update(bool step);
+	void publishSnapshot();
 
 	static int renderGame(void* self);
-	bool renderRequired();
 	void render();
 
 	void handleEvent(SDL_Event e);
 
 public:
-	GameEngine();
+	/* @param universeWidth, universeHeight size of every universe created, it may be larger than the window
+	* @param replayPath trajectory to play back instead of running a universe, empty to run one
+	*/
+	GameEngine(int universeWidth = UNIVERSE_WIDTH, int universeHeight = UNIVERSE_HEIGHT, const std::string& replayPath = "");
 	void run();
 	void quit();
 };
\ No newline at end of file
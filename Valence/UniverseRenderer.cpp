@@ -0,0 +1,267 @@
+#include "UniverseRenderer.h"
+#include "Config.h"
+#include <cmath>
+
+const double MIN_ZOOM = 1.0 / 256;
+const double MAX_ZOOM = 64;
+const double ZOOM_STEP = 1.25; //zoom change per notch of the mouse wheel
+
+//FIXME PROTON COLOR
+static const int PROTON_RED[8] = { 75,   0,   0,  55, 122, 255, 240, 200 };
+static const int PROTON_GREEN[8] = { 255, 155, 50, 200, 188, 122, 100,  0 };
+static const int PROTON_BLUE[8] = { 255, 255, 220, 105,  42,  42, 155,  25 };
+
+static Uint32 argb(int red, int green, int blue) {
+	return 0xff000000u | ((Uint32)red << 16) | ((Uint32)green << 8) | (Uint32)blue;
+}
+
+/* Colour of a block with atoms spread over cells, dimmer the fewer cells hold an atom
+*/
+static Uint32 heatColor(uint32_t atoms, uint32_t protons, uint32_t cells) {
+	if (atoms == 0) {
+		return argb(0, 0, 0);
+	}
+	double intensity = sqrt((double)atoms / cells);
+	int average = (int)((protons + atoms / 2) / atoms);
+	int red = 122, green = 122, blue = 122; //no protons only neutrons
+	if (average) {
+		red = PROTON_RED[average % 8];
+		green = PROTON_GREEN[average % 8];
+		blue = PROTON_BLUE[average % 8];
+	}
+	return argb((int)(red * intensity), (int)(green * intensity), (int)(blue * intensity));
+}
+
+UniverseRenderer::UniverseRenderer(unsigned short int pixelSize) {
+	this->pixelSize = pixelSize;
+	this->drawCount = 0;
+	this->texture = nullptr;
+	this->textureWidth = this->textureHeight = 0;
+	this->camera.viewX = this->camera.viewY = 0;
+	this->camera.zoom = pixelSize;
+	this->dragging = false;
+	this->mouse.x = this->mouse.y = 0;
+}
+
+UniverseRenderer::~UniverseRenderer() {
+	if (this->texture) {
+		SDL_DestroyTexture(this->texture);
+	}
+}
+
+bool UniverseRenderer::lockTexture(SDL_Renderer* ren, int width, int height, Uint32** pixels, int* rowTexels) {
+	if (this->texture == nullptr || width > this->textureWidth || height > this->textureHeight) {
+		if (this->texture) {
+			SDL_DestroyTexture(this->texture);
+		}
+		this->textureWidth = std::max(width, this->textureWidth);
+		this->textureHeight = std::max(height, this->textureHeight);
+		//each texel is stretched to a square of pixels, keep its edges sharp
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+		this->texture = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, this->textureWidth, this->textureHeight);
+		if (this->texture == nullptr) {
+			printf("SDL_CreateTexture Error: %s\n", SDL_GetError());
+			this->textureWidth = this->textureHeight = 0;
+			return false;
+		}
+	}
+	SDL_Rect area;
+	area.x = area.y = 0;
+	area.w = width;
+	area.h = height;
+	void* locked;
+	int pitch;
+	if (SDL_LockTexture(this->texture, &area, &locked, &pitch) != 0) {
+		return false;
+	}
+	*pixels = (Uint32*)locked;
+	*rowTexels = pitch / (int)sizeof(Uint32);
+	return true;
+}
+
+void UniverseRenderer::fillAtoms(Uint32* pixels, int rowTexels, const RenderSnapshot& snapshot, int x0, int y0, int x1, int y1, int renderOffset) {
+	Uint32 protonColor[8];
+	for (int i = 0; i < 8; i++) {
+		protonColor[i] = argb(PROTON_RED[i], PROTON_GREEN[i], PROTON_BLUE[i]);
+	}
+	const Uint32 neutronColor = argb(122, 122, 122);
+	const Uint32 electronColor = argb(250, 255, 255);
+	const Uint32 black = argb(0, 0, 0);
+
+	const int xReorder[8] = { 0, 1, 2, 2, 2, 1, 0, 0 };
+	const int yReorder[8] = { 0, 0, 0, 1, 2, 2, 2, 1 };
+	for (int y = y0; y < y1; y++) {
+		Uint32* row = pixels + (size_t)(y - y0) * 3 * rowTexels;
+		for (int x = x0; x < x1; x++) {
+			const CellView& atom = snapshot.at(y, x);
+			Uint32* block = row + (x - x0) * 3;
+			Uint32 nucleus = black;
+			if (atom.protons) {
+				nucleus = protonColor[atom.protons % 8];
+			}
+			else if (atom.neutrons) { //no protons only neutrons
+				nucleus = neutronColor;
+			}
+			block[rowTexels + 1] = nucleus;
+			//turn the whole shell by the spin once instead of wrapping every position
+			uint8_t shell = rotateValence(atom.valence, -renderOffset);
+			for (int i = 0; i < 8; i++) {
+				block[yReorder[i] * rowTexels + xReorder[i]] = (shell >> i) & 1 ? electronColor : black;
+			}
+		}
+	}
+}
+
+void UniverseRenderer::fillHeatmap(Uint32* pixels, int rowTexels, const RenderSnapshot& snapshot, const BlockLevel& level, int x0, int y0, int x1, int y1) {
+	for (int y = y0; y < y1; y++) {
+		Uint32* row = pixels + (size_t)(y - y0) * rowTexels;
+		//blocks on the far edge of the universe can hold fewer cells
+		uint32_t rows = std::min(level.side, snapshot.height - y * level.side);
+		for (int x = x0; x < x1; x++) {
+			uint32_t columns = std::min(level.side, snapshot.width - x * level.side);
+			const BlockView& block = level.at(y, x);
+			row[x - x0] = heatColor(block.atoms, block.protons, rows * columns);
+		}
+	}
+}
+
+void UniverseRenderer::drawEmptyOutlines(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int x0, int y0, int x1, int y1) {
+	this->emptyOutlines.clear();
+	int size = (int)lround(view.zoom);
+	for (int y = y0; y < y1; y++) {
+		for (int x = x0; x < x1; x++) {
+			if (snapshot.at(y, x).isEmpty()) {
+				SDL_Rect rect;
+				rect.w = rect.h = size;
+				rect.x = (int)lround((x * 3 + 1 - view.viewX) * view.zoom);
+				rect.y = (int)lround((y * 3 + 1 - view.viewY) * view.zoom);
+				this->emptyOutlines.push_back(rect);
+			}
+		}
+	}
+	SDL_SetRenderDrawColor(ren, 70, 70, 70, 255);
+	SDL_RenderDrawRects(ren, this->emptyOutlines.data(), (int)this->emptyOutlines.size());
+	SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+}
+
+void UniverseRenderer::drawAtoms(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int width, int height) {
+	//atoms at least partly inside the window
+	int x0 = std::max(0, (int)floor(view.viewX / 3));
+	int y0 = std::max(0, (int)floor(view.viewY / 3));
+	int x1 = std::min(snapshot.width, (int)ceil((view.viewX + width / view.zoom) / 3));
+	int y1 = std::min(snapshot.height, (int)ceil((view.viewY + height / view.zoom) / 3));
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+	Uint32* pixels;
+	int rowTexels;
+	if (!this->lockTexture(ren, (x1 - x0) * 3, (y1 - y0) * 3, &pixels, &rowTexels)) {
+		return;
+	}
+	this->fillAtoms(pixels, rowTexels, snapshot, x0, y0, x1, y1, this->drawCount);
+	SDL_UnlockTexture(this->texture);
+
+	SDL_Rect source, target;
+	source.x = source.y = 0;
+	source.w = (x1 - x0) * 3;
+	source.h = (y1 - y0) * 3;
+	target.x = (int)lround((x0 * 3 - view.viewX) * view.zoom);
+	target.y = (int)lround((y0 * 3 - view.viewY) * view.zoom);
+	target.w = (int)lround((x1 * 3 - view.viewX) * view.zoom) - target.x;
+	target.h = (int)lround((y1 * 3 - view.viewY) * view.zoom) - target.y;
+	SDL_RenderCopy(ren, this->texture, &source, &target);
+	if (SHOW_EMPTY) {
+		this->drawEmptyOutlines(ren, snapshot, view, x0, y0, x1, y1);
+	}
+}
+
+void UniverseRenderer::drawHeatmap(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int width, int height) {
+	if (snapshot.levels.empty()) {
+		return;
+	}
+	//smallest blocks that still cover a whole pixel
+	size_t l = 0;
+	while (l + 1 < snapshot.levels.size() && snapshot.levels[l].side * 3 * view.zoom < 1) {
+		l++;
+	}
+	const BlockLevel& level = snapshot.levels[l];
+	double blockUnits = level.side * 3.0;
+	int x0 = std::max(0, (int)floor(view.viewX / blockUnits));
+	int y0 = std::max(0, (int)floor(view.viewY / blockUnits));
+	int x1 = std::min(level.columns, (int)ceil((view.viewX + width / view.zoom) / blockUnits));
+	int y1 = std::min(level.rows, (int)ceil((view.viewY + height / view.zoom) / blockUnits));
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+	Uint32* pixels;
+	int rowTexels;
+	if (!this->lockTexture(ren, x1 - x0, y1 - y0, &pixels, &rowTexels)) {
+		return;
+	}
+	this->fillHeatmap(pixels, rowTexels, snapshot, level, x0, y0, x1, y1);
+	SDL_UnlockTexture(this->texture);
+
+	SDL_Rect source, target;
+	source.x = source.y = 0;
+	source.w = x1 - x0;
+	source.h = y1 - y0;
+	target.x = (int)lround((x0 * blockUnits - view.viewX) * view.zoom);
+	target.y = (int)lround((y0 * blockUnits - view.viewY) * view.zoom);
+	target.w = (int)lround((x1 * blockUnits - view.viewX) * view.zoom) - target.x;
+	target.h = (int)lround((y1 * blockUnits - view.viewY) * view.zoom) - target.y;
+	SDL_RenderCopy(ren, this->texture, &source, &target);
+}
+
+void UniverseRenderer::draw(SDL_Renderer* ren, const RenderSnapshot& snapshot) {
+	if (snapshot.width == 0) {
+		return;
+	}
+	Camera view;
+	{
+		std::lock_guard<std::mutex> lock(this->cameraLock);
+		view = this->camera;
+	}
+	int width, height;
+	if (SDL_GetRendererOutputSize(ren, &width, &height) != 0) {
+		return;
+	}
+	//a unit smaller than a pixel would alias, show the heatmap instead
+	if (view.zoom >= 1) {
+		this->drawAtoms(ren, snapshot, view, width, height);
+	}
+	else {
+		this->drawHeatmap(ren, snapshot, view, width, height);
+	}
+	if (ELECTRON_SPIN) {
+		this->drawCount++;
+	}
+}
+
+void UniverseRenderer::handleEvent(SDL_Event e, SDL_Point m) {
+	std::lock_guard<std::mutex> lock(this->cameraLock);
+	if (e.type == SDL_MOUSEMOTION) {
+		if (this->dragging) {
+			this->camera.viewX -= (m.x - this->mouse.x) / this->camera.zoom;
+			this->camera.viewY -= (m.y - this->mouse.y) / this->camera.zoom;
+		}
+		this->mouse = m;
+	}
+	else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) {
+		if (e.button.button == SDL_BUTTON_RIGHT || e.button.button == SDL_BUTTON_MIDDLE) {
+			this->dragging = e.type == SDL_MOUSEBUTTONDOWN;
+			this->mouse = m;
+		}
+	}
+	else if (e.type == SDL_MOUSEWHEEL) {
+		double zoom = this->camera.zoom * pow(ZOOM_STEP, e.wheel.y);
+		zoom = std::min(MAX_ZOOM, std::max(MIN_ZOOM, zoom));
+		//keep the unit under the cursor where it is
+		this->camera.viewX += this->mouse.x / this->camera.zoom - this->mouse.x / zoom;
+		this->camera.viewY += this->mouse.y / this->camera.zoom - this->mouse.y / zoom;
+		this->camera.zoom = zoom;
+	}
+	else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_h) {
+		this->camera.viewX = this->camera.viewY = 0;
+		this->camera.zoom = this->pixelSize;
+	}
+}
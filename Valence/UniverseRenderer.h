@@ -0,0 +1,81 @@
+#pragma once
+
+#include <SDL.h>
+#include <mutex>
+#include <vector>
+#include "Universe.h"
+
+/* Part of the universe shown on screen
+* view is the universe position (in units, 3 per atom) at the top left corner of the window,
+* zoom is the number of screen pixels per unit
+*/
+struct Camera {
+	double viewX, viewY;
+	double zoom;
+};
+
+/*
+* SDL front end for a Universe
+*
+* The universe itself knows nothing about the screen, the renderer draws a RenderSnapshot
+* of it so drawing never has to wait for an update. Each atom is a 3x3 block of units
+* (nucleus in the middle, valence shell around it), every unit is one texel of a streaming
+* texture that is filled on the CPU and stretched on screen by the camera's zoom.
+*
+* Only the atoms inside the window are written to the texture. Once a unit would be smaller
+* than a pixel the renderer switches to a heatmap of the snapshot's blocks instead,
+* picking the smallest blocks that still cover a pixel, so a frame costs about one texel
+* per screen pixel however large the universe is.
+*
+* Mouse wheel zooms around the cursor, dragging with the right or middle button pans, H resets the view.
+*/
+class UniverseRenderer {
+	unsigned short int pixelSize;
+	int drawCount;
+
+	SDL_Texture* texture;
+	int textureWidth, textureHeight; //grown as needed, frames use the top left part
+	std::vector<SDL_Rect> emptyOutlines; //reused by SHOW_EMPTY
+
+	//events arrive on the main thread while drawing happens on the render thread
+	std::mutex cameraLock;
+	Camera camera;
+	bool dragging;
+	SDL_Point mouse;
+
+	/* Makes sure the texture holds at least width x height texels and locks that part of it
+	* @return false if no texture could be made
+	*/
+	bool lockTexture(SDL_Renderer* ren, int width, int height, Uint32** pixels, int* rowTexels);
+
+	/* Writes every unit of atoms [x0, x1) x [y0, y1) into locked texture memory
+	*
+	* @param renderOffset spin on the electrons for display
+	*/
+	void fillAtoms(Uint32* pixels, int rowTexels, const RenderSnapshot& snapshot, int x0, int y0, int x1, int y1, int renderOffset);
+
+	/* One texel per block of the level, blocks [x0, x1) x [y0, y1)
+	* brightness follows how many cells hold an atom, colour the average number of protons
+	*/
+	void fillHeatmap(Uint32* pixels, int rowTexels, const RenderSnapshot& snapshot, const BlockLevel& level, int x0, int y0, int x1, int y1);
+
+	/* Outlines empty atoms in one batched call, SHOW_EMPTY only
+	*/
+	void drawEmptyOutlines(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int x0, int y0, int x1, int y1);
+
+	void drawAtoms(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int width, int height);
+	void drawHeatmap(SDL_Renderer* ren, const RenderSnapshot& snapshot, const Camera& view, int width, int height);
+
+public:
+	/* @param pixelSize display size of 1 unit (electron/nucleus) of the grid at the starting zoom
+	*/
+	UniverseRenderer(unsigned short int pixelSize = 7);
+	~UniverseRenderer();
+
+	UniverseRenderer(const UniverseRenderer&) = delete;
+	UniverseRenderer& operator=(const UniverseRenderer&) = delete;
+
+	void draw(SDL_Renderer* ren, const RenderSnapshot& snapshot);
+
+	void handleEvent(SDL_Event e, SDL_Point m);
+};
@@ -1,10 +1,36 @@
 #include <iostream>
+#include <string>
 #include "GameEngine.h"
 
+/* usage: Valence [--size N] [--width N] [--height N] [--replay FILE]
+*/
 int main(int argc, char** argv) {
 	std::cout << "Welcome to valence, this program does nothing thanks" << std::endl;
-	GameEngine* valence = new GameEngine();
+	int width = UNIVERSE_WIDTH;
+	int height = UNIVERSE_HEIGHT;
+	std::string replay;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		int value = atoi(argv[i + 1]);
+		if (arg == "--size") {
+			width = height = value;
+		}
+		else if (arg == "--width") {
+			width = value;
+		}
+		else if (arg == "--height") {
+			height = value;
+		}
+		else if (arg == "--replay") {
+			replay = argv[i + 1];
+		}
+	}
+	if (width < 1 || height < 1) {
+		std::cout << "width and height must be at least 1" << std::endl;
+		return 1;
+	}
+	GameEngine* valence = new GameEngine(width, height, replay);
 	valence->run();
 	std::cin.get();
 	return 0;
-}
\ No newline at end of file
+}
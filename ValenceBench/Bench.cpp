@@ -0,0 +1,467 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include "Config.h"
+#include "Universe.h"
+#include "ForceEdges.h"
+#include "ForceKernels.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+* Benchmark driver
+*
+* Microbenchmarks time the pieces an update is built from: working out an atom's coefficients,
+* measuring a pair force, looking one up in the species table and the sync and net force row
+* kernels at every instruction set the CPU supports. Macrobenchmarks time whole updates of seeded
+* universes over a range of sizes, densities, engines and thread counts.
+*
+* Every result is one line of CSV (the default) or one JSON object per line, so runs can be kept
+* and compared by a script. Progress goes to stderr.
+*
+* usage: ValenceBench [--micro] [--macro] [--sizes N,N,...] [--cells-per-atom N,N,...] [--threads N,N,...]
+*                     [--engines serial,tiled,fused] [--recompute changed|all] [--seed N] [--min-time S]
+*                     [--max-memory MB] [--format csv|json] [--output FILE]
+*/
+
+struct BenchOptions {
+	bool micro = false;
+	bool macro = false;
+	std::vector<int> sizes = { 32, 128, 512, 2048, 8192 };
+	std::vector<int> cellsPerAtom = { 1, CELLS_PER_ATOM, 32 };
+	std::vector<int> threads = { 1, 0 }; //0 for all hardware threads
+	std::vector<UpdateEngine> engines = { UE_SERIAL, UE_TILED, UE_FUSED };
+	bool incremental = true;
+	uint64_t seed = 1;
+	double minTime = 1.0; //seconds each measurement runs for at least
+	size_t maxMemory = 0; //bytes a universe may take, sizes above it are skipped, 0 for half the physical memory
+	bool json = false;
+	std::string output;
+};
+
+/* One line of output, the fields that do not apply to a benchmark are left out
+*/
+struct BenchResult {
+	std::string suite; //micro or macro
+	std::string name;
+	std::string simd;
+	int size = 0;
+	int cellsPerAtom = 0;
+	std::string engine;
+	int threads = 0;
+	uint64_t iterations = 0; //operations or updates timed
+	double seconds = 0;
+	double nsPerOp = 0;      //per operation, per cell for the row kernels, per update for macro
+	double stepsPerSecond = 0;
+	double nsPerCell = 0;
+};
+
+//results a benchmark computes are added here so the compiler cannot drop the work
+static volatile double sink;
+
+static const char* engineName(UpdateEngine engine) {
+	switch (engine) {
+	case UE_TILED: return "tiled";
+	case UE_FUSED: return "fused";
+	default: return "serial";
+	}
+}
+
+static void printUsage(const char* program) {
+	std::cout << "usage: " << program << " [options]" << std::endl;
+	std::cout << "  --micro         run the microbenchmarks" << std::endl;
+	std::cout << "  --macro         run the update benchmarks (both run when neither is given)" << std::endl;
+	std::cout << "  --sizes L       atoms along each side of the universes, a comma separated list (default 32,128,512,2048,8192)" << std::endl;
+	std::cout << "  --cells-per-atom L one cell in N draws an atom, a list of densities (default 1," << CELLS_PER_ATOM << ",32)" << std::endl;
+	std::cout << "  --threads L     thread counts of the tiled engine, 0 for all hardware threads (default 1,0)" << std::endl;
+	std::cout << "  --engines L     any of serial, tiled and fused (default all three)" << std::endl;
+	std::cout << "  --recompute R   changed (default) or all, see ValenceHeadless" << std::endl;
+	std::cout << "  --seed N        seed of every universe (default 1)" << std::endl;
+	std::cout << "  --min-time S    seconds each measurement runs for at least (default 1)" << std::endl;
+	std::cout << "  --max-memory MB skip universes that need more (default: half the physical memory)" << std::endl;
+	std::cout << "  --format F      csv (default) or json, one object per line" << std::endl;
+	std::cout << "  --output FILE   write the results to FILE instead of stdout" << std::endl;
+}
+
+static std::vector<std::string> splitList(const std::string& value) {
+	std::vector<std::string> items;
+	std::stringstream in(value);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		items.push_back(item);
+	}
+	return items;
+}
+
+static std::vector<int> parseInts(const std::string& value, int smallest) {
+	std::vector<int> numbers;
+	for (const std::string& item : splitList(value)) {
+		int number = std::stoi(item);
+		if (number < smallest) {
+			throw std::invalid_argument(item);
+		}
+		numbers.push_back(number);
+	}
+	if (numbers.empty()) {
+		throw std::invalid_argument(value);
+	}
+	return numbers;
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--help" || arg == "-h") {
+			return false;
+		}
+		if (arg == "--micro") {
+			options.micro = true;
+			continue;
+		}
+		if (arg == "--macro") {
+			options.macro = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+		try {
+			if (arg == "--sizes") {
+				options.sizes = parseInts(value, 1);
+			}
+			else if (arg == "--cells-per-atom") {
+				options.cellsPerAtom = parseInts(value, 1);
+			}
+			else if (arg == "--threads") {
+				options.threads = parseInts(value, 0);
+			}
+			else if (arg == "--engines") {
+				options.engines.clear();
+				for (const std::string& item : splitList(value)) {
+					if (item == "serial") {
+						options.engines.push_back(UE_SERIAL);
+					}
+					else if (item == "tiled") {
+						options.engines.push_back(UE_TILED);
+					}
+					else if (item == "fused") {
+						options.engines.push_back(UE_FUSED);
+					}
+					else {
+						std::cerr << "unknown engine " << item << std::endl;
+						return false;
+					}
+				}
+			}
+			else if (arg == "--recompute") {
+				if (value == "changed") {
+					options.incremental = true;
+				}
+				else if (value == "all") {
+					options.incremental = false;
+				}
+				else {
+					std::cerr << "unknown recompute mode " << value << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--seed") {
+				options.seed = std::stoull(value);
+			}
+			else if (arg == "--min-time") {
+				options.minTime = std::stod(value);
+			}
+			else if (arg == "--max-memory") {
+				options.maxMemory = (size_t)std::stoull(value) * 1024 * 1024;
+			}
+			else if (arg == "--format") {
+				if (value == "csv" || value == "json") {
+					options.json = value == "json";
+				}
+				else {
+					std::cerr << "unknown format " << value << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--output") {
+				options.output = value;
+			}
+			else {
+				std::cerr << "unknown option " << arg << std::endl;
+				return false;
+			}
+		}
+		catch (const std::exception&) {
+			std::cerr << "invalid value for " << arg << ": " << value << std::endl;
+			return false;
+		}
+	}
+	if (!options.micro && !options.macro) {
+		options.micro = options.macro = true;
+	}
+	return true;
+}
+
+static void writeHeader(std::ostream& out, bool json) {
+	if (!json) {
+		out << "suite,name,simd,size,cells_per_atom,engine,threads,iterations,seconds,ns_per_op,steps_per_sec,ns_per_cell\n";
+	}
+}
+
+static void writeResult(std::ostream& out, bool json, const BenchResult& r) {
+	if (json) {
+		out << "{\"suite\":\"" << r.suite << "\",\"name\":\"" << r.name << "\"";
+		if (!r.simd.empty()) {
+			out << ",\"simd\":\"" << r.simd << "\"";
+		}
+		if (r.size) {
+			out << ",\"size\":" << r.size << ",\"cells_per_atom\":" << r.cellsPerAtom << ",\"engine\":\"" << r.engine
+				<< "\",\"threads\":" << r.threads;
+		}
+		out << ",\"iterations\":" << r.iterations << ",\"seconds\":" << r.seconds << ",\"ns_per_op\":" << r.nsPerOp;
+		if (r.size) {
+			out << ",\"steps_per_sec\":" << r.stepsPerSecond << ",\"ns_per_cell\":" << r.nsPerCell;
+		}
+		out << "}\n";
+	}
+	else {
+		out << r.suite << "," << r.name << "," << r.simd << ",";
+		if (r.size) {
+			out << r.size << "," << r.cellsPerAtom << "," << r.engine << "," << r.threads;
+		}
+		else {
+			out << ",,,";
+		}
+		out << "," << r.iterations << "," << r.seconds << "," << r.nsPerOp << ",";
+		if (r.size) {
+			out << r.stepsPerSecond << "," << r.nsPerCell;
+		}
+		else {
+			out << ",";
+		}
+		out << "\n";
+	}
+	out.flush();
+}
+
+/* Runs batch(first, count) with growing batches until minTime has passed
+* batch does count operations numbered from first
+*/
+template <class Batch>
+static BenchResult timeBatches(const std::string& name, double minTime, Batch batch) {
+	BenchResult result;
+	result.suite = "micro";
+	result.name = name;
+	uint64_t count = 1;
+	auto start = std::chrono::steady_clock::now();
+	double elapsed = 0;
+	while (elapsed < minTime) {
+		auto batchStart = std::chrono::steady_clock::now();
+		batch(result.iterations, count);
+		auto now = std::chrono::steady_clock::now();
+		result.iterations += count;
+		elapsed = std::chrono::duration<double>(now - start).count();
+		//grow until a batch is long enough that reading the clock does not count
+		if (std::chrono::duration<double>(now - batchStart).count() < 0.01) {
+			count *= 2;
+		}
+	}
+	result.seconds = elapsed;
+	result.nsPerOp = elapsed * 1e9 / result.iterations;
+	return result;
+}
+
+//a force in [-10, 10] drawn from the seed
+static force_t randomForce(uint64_t seed, uint64_t i) {
+	CounterRandom random(seed, i, 0);
+	return (force_t)((random.nextInt(2001) - 1000) / 100.0);
+}
+
+static void runMicro(const BenchOptions& options, std::ostream& out) {
+	std::cerr << "microbenchmarks" << std::endl;
+	//the species a layout holds, (pne, pne, pne) for pne 1 to 8
+	Atom atoms[8];
+	SpeciesTable table;
+	SpeciesId ids[8];
+	for (int i = 0; i < 8; i++) {
+		atoms[i] = Atom(i + 1, i + 1, i + 1);
+		ids[i] = table.idOf(atoms[i]);
+	}
+
+	writeResult(out, options.json, timeBatches("atom_coefficients", options.minTime, [](uint64_t first, uint64_t count) {
+		double sum = 0;
+		for (uint64_t i = first; i < first + count; i++) {
+			int protons = 1 + (int)(i % 8);
+			Atom atom(protons, protons + (int)(i / 8 % 3), protons + (int)(i / 24 % 3) - 1, (int)(i % 7));
+			sum += atom.totalPressure() + atom.neutronCharge();
+		}
+		sink = sink + sum;
+	}));
+
+	writeResult(out, options.json, timeBatches("pair_force_measure", options.minTime, [&atoms](uint64_t first, uint64_t count) {
+		double sum = 0;
+		for (uint64_t i = first; i < first + count; i++) {
+			sum += atoms[i % 8].measureOuterPressure(&atoms[i / 8 % 8]);
+		}
+		sink = sink + sum;
+	}));
+
+	writeResult(out, options.json, timeBatches("pair_force_lookup", options.minTime, [&table, &ids](uint64_t first, uint64_t count) {
+		force_t sum = 0;
+		for (uint64_t i = first; i < first + count; i++) {
+			sum += table.pairPressure(ids[i % 8], ids[i / 8 % 8]);
+		}
+		sink = sink + sum;
+	}));
+
+	//three rows of random forces, the kernels run over the inner cells of the middle one
+	const size_t width = 4096;
+	const size_t stride = width + 2;
+	const size_t cells = stride * 3;
+	const size_t begin = stride + 1;
+	const size_t end = begin + width;
+	ForceEdges edges(cells);
+	std::vector<force_t> lanes(cells * 8);
+	std::vector<NetForce> net(cells);
+	force_t* force[8];
+	for (int e = 0; e < 4; e++) {
+		for (size_t c = 0; c < cells; c++) {
+			edges.edge[e][c] = randomForce(options.seed, e * cells + c);
+		}
+	}
+	for (int d = 0; d < 8; d++) {
+		force[d] = &lanes[d * cells];
+	}
+	for (int level = SIMD_SCALAR; level < SIMD_BEST; level++) {
+		const ForceKernels& kernels = forceKernels((SimdLevel)level);
+		if (kernels.level != level) {
+			continue; //the CPU does not support it
+		}
+		BenchResult sync = timeBatches("sync_row", options.minTime, [&](uint64_t, uint64_t count) {
+			for (uint64_t i = 0; i < count; i++) {
+				kernels.syncRow(edges.edge, force, stride, begin, end);
+			}
+			sink = sink + force[F_TOPL][begin];
+		});
+		BenchResult netForce = timeBatches("net_force_row", options.minTime, [&](uint64_t, uint64_t count) {
+			for (uint64_t i = 0; i < count; i++) {
+				kernels.netForceRow(force, begin, end, net.data());
+			}
+			sink = sink + net[begin].dx;
+		});
+		for (BenchResult* row : { &sync, &netForce }) {
+			//a row kernel call is width operations, one per cell
+			row->simd = simdLevelName(kernels.level);
+			row->iterations *= width;
+			row->nsPerOp /= width;
+			writeResult(out, options.json, *row);
+		}
+	}
+}
+
+static void runUniverse(const BenchOptions& options, std::ostream& out, int size, int cellsPerAtom, UpdateEngine engine, int threads) {
+	std::cerr << "size " << size << "x" << size << " cells-per-atom " << cellsPerAtom << " engine " << engineName(engine);
+	if (engine == UE_TILED) {
+		std::cerr << " threads " << threads;
+	}
+	std::cerr << " memory " << Universe::memoryFor(size, size) / (1024 * 1024) << " MB" << std::endl;
+	Universe universe(size, size, options.seed, BM_TORUS, cellsPerAtom);
+	universe.setEngine(engine, threads);
+	universe.setIncremental(options.incremental);
+	//the first update measures every force whatever the recompute mode, it is left out
+	universe.update();
+	BenchResult result;
+	result.suite = "macro";
+	result.name = "update";
+	result.simd = simdLevelName(universe.getSimdLevel());
+	result.size = size;
+	result.cellsPerAtom = cellsPerAtom;
+	result.engine = engineName(engine);
+	result.threads = universe.threadCount();
+	auto start = std::chrono::steady_clock::now();
+	//at least two updates, an incremental one can differ from the one after it
+	while (result.iterations < 2 || result.seconds < options.minTime) {
+		universe.update();
+		result.iterations++;
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	result.nsPerOp = result.seconds * 1e9 / result.iterations;
+	result.stepsPerSecond = result.iterations / result.seconds;
+	result.nsPerCell = result.nsPerOp / ((double)size * size);
+	writeResult(out, options.json, result);
+}
+
+/* Memory installed in the machine, 0 when it cannot be found out
+*/
+static size_t physicalMemory() {
+#ifdef _WIN32
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	return GlobalMemoryStatusEx(&status) ? (size_t)status.ullTotalPhys : 0;
+#else
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGE_SIZE);
+	return pages > 0 && pageSize > 0 ? (size_t)pages * (size_t)pageSize : 0;
+#endif
+}
+
+static void runMacro(const BenchOptions& options, std::ostream& out) {
+	//a universe that does not fit gets the process killed and every result after it lost, so it is skipped up front
+	size_t budget = options.maxMemory ? options.maxMemory : physicalMemory() / 2;
+	for (int size : options.sizes) {
+		if (budget && Universe::memoryFor(size, size) > budget) {
+			std::cerr << "skipping size " << size << "x" << size << ", it needs " << Universe::memoryFor(size, size) / (1024 * 1024)
+				<< " MB and " << budget / (1024 * 1024) << " MB are allowed (see --max-memory)" << std::endl;
+			continue;
+		}
+		for (int cellsPerAtom : options.cellsPerAtom) {
+			for (UpdateEngine engine : options.engines) {
+				if (engine != UE_TILED) {
+					runUniverse(options, out, size, cellsPerAtom, engine, 1);
+					continue;
+				}
+				for (int threads : options.threads) {
+					runUniverse(options, out, size, cellsPerAtom, engine, threads);
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	std::ofstream file;
+	if (!options.output.empty()) {
+		file.open(options.output);
+		if (!file) {
+			std::cerr << "could not open " << options.output << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = options.output.empty() ? std::cout : file;
+	writeHeader(out, options.json);
+	if (options.micro) {
+		runMicro(options, out);
+	}
+	if (options.macro) {
+		runMacro(options, out);
+	}
+	return 0;
+}
@@ -0,0 +1,168 @@
+#include "Atom.h"
+#include "Config.h"
+
+Atom::Atom() {
+	this->protons = this->electrons = this->neutrons = this->vElectrons = 0;
+	this->valence = 0;
+	this->updateCoefficients();
+}
+
+Atom::Atom(int protons, int neutrons, int electrons, int startingPosition) {
+	this->protons = protons;
+	this->electrons = electrons == -1 ? protons : electrons;
+	this->neutrons = neutrons == -1 ? protons : neutrons;
+	this->vElectrons = electrons % 8;
+	if (electrons != 0 && vElectrons == 0) {
+		this->vElectrons = 8;
+	}
+	int oElectrons = 8 - vElectrons;
+	int valenceRatio = 1, unsetRatio = 1;
+
+	//spread the electrons evenly from position 0, then turn the shell to its starting position
+	uint8_t shell = 0;
+	for (int i = 0; i < 8; i++) {
+		if (valenceRatio * oElectrons < unsetRatio * vElectrons) {
+			valenceRatio++;
+			shell |= 1 << i;
+		}
+		else {
+			unsetRatio++;
+		}
+	}
+	this->valence = rotateValence(shell, startingPosition);
+	this->updateCoefficients();
+	if (DEBUG && PRINT_ATOM_INIT) {
+		if (!this->isEmpty() || INCLUDE_EMPTY_INIT) {
+			std::cout << "Atom(P:" << this->protons << " N:" << this->neutrons << " E" << this->electrons;
+			std::cout << ") Radial: " << this->radialPressure() << "  Nucleoid: " << this->nucleoidPressure() << std::endl;
+		}
+	}
+}
+
+bool Atom::isEmpty() const {
+	return (!this->protons && !this->electrons && !this->neutrons);
+}
+void Atom::setEmpty() {
+	this->protons = 0;
+	this->neutrons = 0;
+	this->electrons = 0;
+	this->vElectrons = 0;
+	this->valence = 0;
+	this->updateCoefficients();
+}
+void Atom::setValue(const Atom* atom) {
+	this->protons = atom->protons;
+	this->neutrons = atom->neutrons;
+	this->electrons = atom->electrons;
+	this->vElectrons = atom->vElectrons;
+	this->valence = atom->valence;
+	this->coefficients = atom->coefficients;
+}
+int Atom::getProtons() const {
+	return this->protons;
+}
+int Atom::getNeutrons() const {
+	return this->neutrons;
+}
+int Atom::getElectrons() const {
+	return this->electrons;
+}
+int Atom::getValenceElectrons() const {
+	return this->vElectrons;
+}
+bool Atom::hasValenceAt(int position) const {
+	return (this->valence >> (position % 8)) & 1;
+}
+
+void Atom::update() {
+	//not sure yet
+}
+
+void Atom::updateCoefficients() {
+	AtomCoefficients& c = this->coefficients;
+	//measure of valence shell filling
+	c.charge = this->protons - this->electrons;
+
+	c.weight = this->protons + this->neutrons * 1.125 + this->electrons * 0.01;
+
+	//measure between neutrons & protons
+	const double sizeCoeff = sqrt(c.weight / 2.0);
+	c.neutronCharge = (this->protons - (this->neutrons * 0.8)) * sizeCoeff;
+
+	//stability of electrons
+	const double chargeCoeff = abs(3 * c.charge);
+	const double valenceCoeff = std::min(this->electrons % 8, 8 - this->electrons % 8) * 12.0;
+	const double weightCoeff = c.weight * 0.6;
+	c.radialPressure = chargeCoeff + valenceCoeff + weightCoeff;
+
+	//stability of the nucleus
+	const double neutronCoeff = 3.0 * abs(c.neutronCharge);
+	c.nucleoidPressure = neutronCoeff * sizeCoeff;
+}
+
+const AtomCoefficients& Atom::getCoefficients() const {
+	return this->coefficients;
+}
+
+int Atom::charge() const {
+	return this->coefficients.charge;
+}
+
+double Atom::weight() const {
+	return this->coefficients.weight;
+}
+
+double Atom::neutronCharge() const {
+	return this->coefficients.neutronCharge;
+}
+
+double Atom::radialPressure() const {
+	return this->coefficients.radialPressure;
+}
+
+double Atom::nucleoidPressure() const {
+	return this->coefficients.nucleoidPressure;
+}
+
+//tertiary calculations
+double Atom::totalPressure() const {
+	return this->coefficients.radialPressure + this->coefficients.nucleoidPressure;
+}
+
+double Atom::measureOuterPressure(const Atom* e, PairBond* bond) const {
+	//positive push
+	//negative pull
+	PairBond ignored;
+	if (bond == nullptr) {
+		bond = &ignored;
+	}
+	*bond = PB_NONE;
+	if (e == nullptr || this->isEmpty()) {
+		return 0;
+	}
+	int netCharge = this->charge() + e->charge();
+	int valenceDiff = abs(this->vElectrons - e->vElectrons);
+	int valenceIonic = this->vElectrons + e->vElectrons;
+	double valenceCovalent = this->vElectrons * 2.0 / 3.0 + e->vElectrons * 2.0 / 3.0;
+	double ionicChance = valenceDiff * (1.0 / 6.0) * 100.0 - abs(valenceIonic - 8.0) * 15.0 - abs(netCharge) * 6.0;
+	double covalentChance = 100.0 - valenceDiff * 8.0 - abs(valenceCovalent - 8.0) * 12.0 - abs(netCharge) * 12.0;
+	if (ionicChance < 50 && covalentChance < 50) { //no bond push away +
+		*bond = PB_REPULSIVE;
+		//add in the abs(ionicChance) to push away the same elements from each other if they don't naturally bond
+		return abs(this->radialPressure() - e->radialPressure() + abs(ionicChance));
+	}
+	else  if (ionicChance > covalentChance) { //ionic bond pull --
+		*bond = PB_IONIC;
+		if (DEBUG && PRINT_BOND_CALCULATION) {
+			std::cout << "IONIC: " << this->electrons << " - " << e->electrons << " chance: " << ionicChance << std::endl;
+		}
+		return abs(this->radialPressure() - e->radialPressure() - abs(ionicChance / 10)) * -1;
+	}
+	else { //covalent bond pull -
+		*bond = PB_COVALENT;
+		if (DEBUG && PRINT_BOND_CALCULATION) {
+			std::cout << "COVALENT: " << this->electrons << " - " << e->electrons << " chance: " << covalentChance << std::endl;
+		}
+		return abs(this->radialPressure() - e->radialPressure() - abs(covalentChance / 10)) * -1;
+	}
+}
\ No newline at end of file
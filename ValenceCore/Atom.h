@@ -1,6 +1,5 @@
 #pragma once
 
-#include <SDL.h>
 #include <iostream>
 #include <string>
 #include <stdlib.h>
@@ -8,9 +7,30 @@
 #include <ctime>
 #include <algorithm>
 #include <vector>
+#include <cstdint>
+
+/* Precision of every stored force (pair forces, synced lanes, net forces)
+* define VALENCE_COMPACT in the build to halve the memory they take, the universe
+* then plays out differently from a double build but is still deterministic
+*/
+#ifdef VALENCE_COMPACT
+typedef float force_t;
+#else
+typedef double force_t;
+#endif
+
+/* Valence shell shifted by positions towards higher bits, bits pushed past 7 come back at 0
+*/
+inline uint8_t rotateValence(uint8_t valence, int positions) {
+	positions &= 7;
+	return (uint8_t)((valence << positions) | (valence >> ((8 - positions) & 7)));
+}
 
 const int RENDER_POSITION[8] = { 0, 1, 2, 4, 7, 6, 5, 3};
 typedef enum OFP {F_TOPL, F_TOP, F_TOPR, F_RIGHT, F_BOTR, F_BOT, F_BOTL, F_LEFT, F_NONE} OFP; //Outer force position
+typedef enum PairBond {PB_NONE, PB_REPULSIVE, PB_IONIC, PB_COVALENT} PairBond; //how two neighbors end up measuring each other
+const int OFP_X[8] = { -1, 0, 1, 1, 1, 0, -1, -1 }; //column offset of the neighbor at each OFP
+const int OFP_Y[8] = { -1, -1, -1, 0, 1, 1, 1, 0 }; //row offset of the neighbor at each OFP
 static OFP getOFP(int x1, int y1, int x2, int y2) {
 	int dx = x2 - x1;
 	int dy = y2 - y1;
@@ -49,6 +69,18 @@ static OFP getOFP(int x1, int y1, int x2, int y2) {
 	}
 }
 
+/*
+* Coefficients derived from an atom's protons/neutrons/electrons
+* worked out once whenever the composition changes instead of on every call
+*/
+struct AtomCoefficients {
+	int charge;
+	double weight;
+	double neutronCharge;
+	double radialPressure;
+	double nucleoidPressure;
+};
+
 /*
 * Base Structure of the universe
 *
@@ -60,21 +92,17 @@ static OFP getOFP(int x1, int y1, int x2, int y2) {
 * universe interaction
 */
 class Atom {
+	friend class AtomGrid;
 protected:
-	int x, y;
 	int protons;
 	int neutrons;
 	int electrons;
 	int vElectrons;
-	bool valence[8];
-	double outerForce[8];
-	unsigned short int pixelSize;
-	bool setOnPass[8];
+	uint8_t valence; //bit i set when valence position i holds an electron
+	AtomCoefficients coefficients;
 
-	void setOuterPressure(double value, OFP position);
-	void setOuterPressure(double value[8]);
-
-	void syncPressureAt(double value, OFP position);
+	//called by everything that changes the composition
+	void updateCoefficients();
 
 public:
 	Atom();
@@ -84,15 +112,13 @@ public:
 	* @param protons +charge, 1 weight center of an atom
 	* @param neutron ~charge 1.125 weight center of an atom
 	* @param electron -charge 0.01 weight outer shell of an atom
-	* @param x position on a grid for display
-	* @param y position on grid for display
-	* @param pixelSize for calculating display offset for (x, y)
+	* @param startingPosition valence position (0-7) the shell starts filling from
 	*/
-	Atom(int protons, int neutrons = -1, int electrons = -1, int x = 0, int y = 0, unsigned short int pixelSize = 8);
+	Atom(int protons, int neutrons = -1, int electrons = -1, int startingPosition = 0);
 	
 	/* No protons/neutrons/electrons
 	*/
-	bool isEmpty();
+	bool isEmpty() const;
 
 	/* Set Protons/Neutrons/Electrons = 0
 	*/
@@ -100,88 +126,55 @@ public:
 
 	/* Copy only Protons/Neutrons/Electrons
 	*/
-	void setValue(Atom* atom);
+	void setValue(const Atom* atom);
 
-	/* Render to the screen
-	*
-	* @param renderOffset spin on the electrons for display
+	int getProtons() const;
+	int getNeutrons() const;
+	int getElectrons() const;
+	int getValenceElectrons() const;
+
+	/* True if the valence shell holds an electron at position (0-7)
+	* used by front ends to display the shell
 	*/
-	void draw(SDL_Renderer* ren, int renderOffset);
+	bool hasValenceAt(int position) const;
 
 	/* Called before all the calculations and movement in the update function
 	* currently does nothing. likely to change into something more useful
 	*/
 	void update();
 
+	/* Every derived coefficient at once, the values below read from here
+	*/
+	const AtomCoefficients& getCoefficients() const;
+
 	/* Difference in protons and electrons
 	* +/- charge of an atom
 	*/
-	int charge();
+	int charge() const;
 
 	/* Mass of an atom*
 	* creates instability in the atom
 	* causes greater magnitude in most calculations
 	*/
-	double weight();
+	double weight() const;
 
 	//measure between neutrons & protons
-	double neutronCharge();
+	double neutronCharge() const;
 
 	//stability of electrons
-	double radialPressure();
+	double radialPressure() const;
 
 	//stability of the nucleus
-	double nucleoidPressure();
+	double nucleoidPressure() const;
 
 	//tertiary calculations
-	double totalPressure();
+	double totalPressure() const;
 
-	double measureOuterPressure(Atom* e);
-	
-	double outerForceAt(OFP position);
-
-	//universe first runs setForceFor. turning setOnPass to true as it goes along
-	void setForceFor(Atom* e, int x1, int y1, int x2, int y2);
-	
-	//runs this if has no neighbors to simulate inertia instead of using setForceFor
-	void setExistingForces(Atom* e, int x1, int y1, int x2, int y2);
-
-	/* Outer force calculated to left-/right+ of an atom 
-	*/
-	double horizontalForce();
-
-	/* Simple horizontal force -1/0/1
-	* used for movement on the grid
-	* see extra notes
-	*/
-	int dx();
-
-	/* Outer force calculated to top-/bottom+ of an atom
-	*/
-	double verticalForce();
-	
-	/* Simple vertical force -1/0/1
- 	* used for movement on the grid
-	* see extra notes
-	*/
-	int dy();
-
-	double topLeftForce();
-	double topForce();
-	double topRightForce();
-	double rightForce();
-	double botLeftForce();
-	double botForce();
-	double botRightForce();
-	double leftForce();
-	
-	/* Add together forces from neighboring atoms
-	*
-	* this distinguishes the force between atoms in space
-	* @param oa neighbors positioned in OFP order
-	*
+	/* Force this atom applies against e
+	* positive pushes the two apart, negative pulls them together
+	* @param bond set to the outcome when not nullptr, PB_NONE when either atom is missing
 	*/
-	void syncPressureWithNeighbors(Atom* oa[8]);
+	double measureOuterPressure(const Atom* e, PairBond* bond = nullptr) const;
 };
 
 
@@ -197,12 +190,13 @@ public:
 
 	Currently the universe will perform these actions on an update
 	- atom -> update
-	- atom -> updateOuterPressure
-	- atom -> syncAtomPressureGrid
-	- Universe -> moveAtoms
+	- Universe -> measureTile (one force per pair of neighbors, see ForceEdges)
+	- Universe -> syncTile
+	- Universe -> claimMove / moveAtoms
+	The synced outer forces themselves are stored per cell in the universe's AtomGrid
 	
-	Currently moveAtoms also only picks empty grid spaces to replace with
-	the greatest force incoming to that grid space, so creating a more interesting
+	Currently an atom only moves into an empty grid space it is heading for, and only when
+	its force is the greatest of the atoms heading there, so creating a more interesting
 	movement method could easily make the atom response more meaningful.
 
 	In future I would like to implement more features regarding the following
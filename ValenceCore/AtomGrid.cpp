@@ -0,0 +1,123 @@
+#include "AtomGrid.h"
+#include <cstdlib>
+#include <cstring>
+
+static const size_t GRID_ALIGNMENT = 64;
+
+static size_t alignedBytes(size_t bytes) {
+	return (bytes + GRID_ALIGNMENT - 1) & ~(GRID_ALIGNMENT - 1);
+}
+
+//cells including the ghost border
+static size_t paddedCells(int width, int height) {
+	return (size_t)(width + 2) * (size_t)(height + 2);
+}
+
+AtomGrid::AtomGrid(int width, int height, SpeciesTable* speciesTable) {
+	this->gridWidth = width;
+	this->gridHeight = height;
+	this->speciesTable = speciesTable;
+	this->rowStride = width + 2;
+	this->cellCount = paddedCells(width, height);
+
+	this->block = allocateBlock(width, height);
+	this->mapping = nullptr;
+	this->carveArrays((unsigned char*)alignedBytes((size_t)this->block));
+}
+
+unsigned char* AtomGrid::allocateBlock(int width, int height) {
+	//one extra alignment worth of bytes so the first array can start on a boundary,
+	//calloc hands back untouched zero pages so a huge grid costs nothing until it is filled
+	unsigned char* block = (unsigned char*)calloc(memoryFor(width, height) + GRID_ALIGNMENT, 1);
+	if (block == nullptr) {
+		std::cout << "Could not allocate a grid of " << width << "x" << height << std::endl;
+		exit(-1);
+	}
+	return block;
+}
+
+AtomGrid::AtomGrid(int width, int height, SpeciesTable* speciesTable, MappedFile* mapping, size_t offset) {
+	this->gridWidth = width;
+	this->gridHeight = height;
+	this->speciesTable = speciesTable;
+	this->rowStride = width + 2;
+	this->cellCount = paddedCells(width, height);
+	this->block = nullptr;
+	this->mapping = mapping;
+	this->carveArrays(mapping->data() + offset);
+}
+
+void AtomGrid::carveArrays(unsigned char* start) {
+	const size_t speciesBytes = alignedBytes(this->cellCount * sizeof(SpeciesId));
+	const size_t forceBytes = alignedBytes(this->cellCount * sizeof(force_t));
+	unsigned char* next = start;
+	for (int i = 0; i < 8; i++) {
+		this->outerForce[i] = (force_t*)next;
+		next += forceBytes;
+	}
+	this->species = (SpeciesId*)next;
+	next += speciesBytes;
+	this->valence = next;
+}
+
+AtomGrid::~AtomGrid() {
+	free(this->block);
+	delete this->mapping;
+}
+
+size_t AtomGrid::memoryUsage() const {
+	return memoryFor(this->gridWidth, this->gridHeight);
+}
+
+bool AtomGrid::isMappedFrom(const std::string& path) const {
+	return this->mapping != nullptr && this->mapping->isFile(path);
+}
+
+void AtomGrid::ownArrays() {
+	if (this->mapping == nullptr) {
+		return;
+	}
+	this->block = allocateBlock(this->gridWidth, this->gridHeight);
+	unsigned char* start = (unsigned char*)alignedBytes((size_t)this->block);
+	memcpy(start, this->storage(), this->memoryUsage());
+	this->carveArrays(start);
+	delete this->mapping;
+	this->mapping = nullptr;
+}
+
+const unsigned char* AtomGrid::storage() const {
+	//the lanes come first, see carveArrays
+	return (const unsigned char*)this->outerForce[0];
+}
+
+size_t AtomGrid::memoryFor(int width, int height) {
+	size_t cells = paddedCells(width, height);
+	return alignedBytes(cells * sizeof(SpeciesId)) + alignedBytes(cells * sizeof(uint8_t))
+		+ 8 * alignedBytes(cells * sizeof(force_t));
+}
+
+Atom AtomGrid::atomAt(size_t i) const {
+	Atom atom = this->speciesAt(i);
+	atom.valence = this->valence[i];
+	return atom;
+}
+
+void AtomGrid::setAtom(size_t i, const Atom& atom) {
+	this->setAtom(i, atom, atom.isEmpty() ? EMPTY_SPECIES : this->speciesTable->idOf(atom));
+}
+
+void AtomGrid::setAtom(size_t i, const Atom& atom, SpeciesId species) {
+	this->species[i] = species;
+	this->valence[i] = atom.valence;
+	for (int p = 0; p < 8; p++) {
+		this->outerForce[p][i] = 0.0;
+	}
+}
+
+void AtomGrid::swapCells(size_t i, size_t j) {
+	std::swap(this->species[i], this->species[j]);
+	std::swap(this->valence[i], this->valence[j]);
+	for (int p = 0; p < 8; p++) {
+		std::swap(this->outerForce[p][i], this->outerForce[p][j]);
+	}
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Atom.h"
+#include "SpeciesTable.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+
+//marks "no cell" where a cell index is expected
+const size_t NO_CELL = (size_t)-1;
+
+/*
+* Flat storage for a width x height grid of atoms
+*
+* Every property of an atom lives in its own contiguous array indexed by cell,
+* so a pass over the universe streams through memory instead of chasing a pointer per atom.
+* All arrays are carved out of a single allocation and start on a 64 byte boundary.
+*
+* The grid is surrounded by a one cell ghost border, rows -1 and height and columns -1 and width are valid
+* for index() so the 8 neighbors of any cell are plain offsets from it (see neighborOffset).
+* The universe fills the ghosts according to its boundary mode.
+*
+* A cell only stores its species and valence shell, protons, neutrons and electrons are
+* the same for every atom of a species and are read from the species table.
+* Positions are never stored, they follow from the index.
+*
+* The arrays are public so the universe's passes can walk them directly.
+* outerForce holds the synced force on each side of an atom, it moves with the atom
+* so an atom with no neighbors can keep applying it (inertia).
+*/
+class AtomGrid {
+	int gridWidth;
+	int gridHeight;
+	int rowStride; //width + 2 for the ghost border
+	size_t cellCount;
+	unsigned char* block;
+	MappedFile* mapping; //the file the arrays live in, nullptr when they were allocated
+	SpeciesTable* speciesTable;
+
+	void carveArrays(unsigned char* start);
+	static unsigned char* allocateBlock(int width, int height); //a zeroed block for the arrays, exits when out of memory
+
+public:
+	SpeciesId* species; //id in the species table, EMPTY_SPECIES for empty cells
+	uint8_t* valence;   //bit i set when valence position i holds an electron
+	force_t* outerForce[8]; //one lane per OFP
+
+	/* @param width, height are the number of atoms along each side of the grid
+	* @param speciesTable shared by every grid of a universe, measures pair forces
+	*/
+	AtomGrid(int width, int height, SpeciesTable* speciesTable);
+
+	/* A grid whose arrays are the block of memoryFor(width, height) bytes at offset in a mapped file,
+	* laid out the way storage() hands them out. The grid takes the mapping over and unmaps it when destroyed
+	* @param offset must keep the block aligned to 64 bytes
+	*/
+	AtomGrid(int width, int height, SpeciesTable* speciesTable, MappedFile* mapping, size_t offset);
+	~AtomGrid();
+
+	AtomGrid(const AtomGrid&) = delete;
+	AtomGrid& operator=(const AtomGrid&) = delete;
+
+	int width() const;
+	int height() const;
+	int stride() const;
+
+	/* Cells including the ghost border
+	*/
+	size_t cells() const;
+
+	/* @param y from -1 to height, x from -1 to width, the outermost values are ghosts
+	*/
+	size_t index(int y, int x) const;
+
+	/* Distance from a cell to its neighbor at position
+	*/
+	ptrdiff_t neighborOffset(OFP position) const;
+
+	/* Bytes held by the grid's arrays
+	*/
+	size_t memoryUsage() const;
+
+	/* Bytes a grid of width x height allocates, known before creating it
+	*/
+	static size_t memoryFor(int width, int height);
+
+	/* Every array of the grid as one block of memoryUsage() bytes, what a checkpoint stores
+	*/
+	const unsigned char* storage() const;
+
+	/* Whether the arrays live in the file at path, see MappedFile::isFile
+	*/
+	bool isMappedFrom(const std::string& path) const;
+
+	/* Copies the arrays out of a mapped file into memory of the grid's own and releases the file
+	* does nothing for a grid that allocated its arrays
+	*/
+	void ownArrays();
+
+	bool isEmpty(size_t i) const;
+
+	/* Composition and valence shell of a cell
+	*/
+	Atom atomAt(size_t i) const;
+
+	/* Place an atom in a cell, clearing its outer forces
+	* registers the atom's species if it is new, any empty atom gets EMPTY_SPECIES
+	*/
+	void setAtom(size_t i, const Atom& atom);
+
+	/* Place an atom whose species is already registered
+	* does not touch the species table, so cells can be filled from several threads
+	*/
+	void setAtom(size_t i, const Atom& atom, SpeciesId species);
+
+	/* Exchange everything two cells hold, outer forces included
+	*/
+	void swapCells(size_t i, size_t j);
+
+	force_t outerForceAt(size_t i, OFP position) const;
+
+	/* Composition shared by every atom of the species in a cell
+	*/
+	const Atom& speciesAt(size_t i) const;
+};
+
+//small accessors used inside every pass are kept inline
+
+inline int AtomGrid::width() const {
+	return this->gridWidth;
+}
+
+inline int AtomGrid::height() const {
+	return this->gridHeight;
+}
+
+inline size_t AtomGrid::cells() const {
+	return this->cellCount;
+}
+
+inline int AtomGrid::stride() const {
+	return this->rowStride;
+}
+
+inline size_t AtomGrid::index(int y, int x) const {
+	return (size_t)(y + 1) * this->rowStride + (x + 1);
+}
+
+inline ptrdiff_t AtomGrid::neighborOffset(OFP position) const {
+	return (ptrdiff_t)OFP_Y[position] * this->rowStride + OFP_X[position];
+}
+
+//the species is the only property ghost cells carry
+inline bool AtomGrid::isEmpty(size_t i) const {
+	return this->species[i] == EMPTY_SPECIES;
+}
+
+inline force_t AtomGrid::outerForceAt(size_t i, OFP position) const {
+	return this->outerForce[position][i];
+}
+
+inline const Atom& AtomGrid::speciesAt(size_t i) const {
+	return this->speciesTable->atomOf(this->species[i]);
+}
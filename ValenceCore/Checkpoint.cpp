@@ -0,0 +1,46 @@
+#include "Checkpoint.h"
+#include "Universe.h"
+#include <cstdint>
+#include <cstring>
+
+size_t checkpointGridOffset(size_t speciesCount) {
+	size_t end = sizeof(CheckpointHeader) + speciesCount * sizeof(CheckpointSpecies);
+	return (end + CHECKPOINT_ALIGNMENT - 1) & ~(CHECKPOINT_ALIGNMENT - 1);
+}
+
+const char* checkpointProblem(const CheckpointHeader& header, size_t fileBytes) {
+	if (fileBytes < sizeof(CheckpointHeader) || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+		return "not a checkpoint";
+	}
+	if (header.version != CHECKPOINT_VERSION) {
+		return "saved by a different version";
+	}
+	if (header.byteOrder != CHECKPOINT_BYTE_ORDER) {
+		return "saved on a machine of the other byte order";
+	}
+	if (header.forceBytes != sizeof(force_t)) {
+		return sizeof(force_t) == sizeof(float) ? "saved by a build with double forces" : "saved by a compact build";
+	}
+	if (header.width < 1 || header.height < 1 || header.boundary > BM_REFLECT) {
+		return "damaged header";
+	}
+	//the grid works out rows and sizes from the width and height, they must not overflow there
+	if (header.width > INT32_MAX - 2 || header.height > INT32_MAX - 2) {
+		return "damaged header";
+	}
+	const uint64_t paddedCells = (uint64_t)(header.width + 2) * (uint64_t)(header.height + 2);
+	const uint64_t mostBytesPerCell = 8 * sizeof(force_t) + sizeof(SpeciesId) + sizeof(uint8_t) + 1; //plus array alignment
+	if (paddedCells > (SIZE_MAX - 1024) / mostBytesPerCell) {
+		return "damaged header";
+	}
+	if (header.speciesCount < 1 || header.speciesCount > 0x10000 || header.gridOffset != checkpointGridOffset((size_t)header.speciesCount)) {
+		return "damaged species table";
+	}
+	if (header.gridBytes != AtomGrid::memoryFor(header.width, header.height)) {
+		return "grid laid out differently";
+	}
+	if (header.gridOffset > fileBytes || header.gridBytes > fileBytes - header.gridOffset) {
+		return "file is cut short";
+	}
+	return nullptr;
+}
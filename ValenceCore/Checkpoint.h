@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Atom.h"
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Binary checkpoint of a universe, see Universe::saveCheckpoint and Universe::openCheckpoint
+*
+* A checkpoint is the header, the composition of every species in id order, then the atom grid's block
+* byte for byte (AtomGrid::storage) starting on a CHECKPOINT_ALIGNMENT boundary. Opening one maps the
+* file and points the grid at that block, nothing is parsed or copied, pages come in as the update
+* first touches them. Values are stored in the byte order and force_t of the build that saved them,
+* a build that would read them differently refuses the file.
+*
+* Bump CHECKPOINT_VERSION whenever the header, the species entries or the grid's layout change.
+*/
+
+const char CHECKPOINT_MAGIC[8] = { 'V', 'A', 'L', 'E', 'N', 'C', 'E', '\0' };
+const uint32_t CHECKPOINT_VERSION = 1;
+const uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304; //reads back differently on a machine of the other byte order
+const size_t CHECKPOINT_ALIGNMENT = 4096;          //a page on every system the universe runs on
+
+struct CheckpointHeader {
+	char magic[8];         //CHECKPOINT_MAGIC
+	uint32_t version;      //CHECKPOINT_VERSION of the build that saved it
+	uint32_t byteOrder;    //CHECKPOINT_BYTE_ORDER as the saving machine stores it
+	uint32_t forceBytes;   //sizeof(force_t) of the build that saved it
+	uint32_t boundary;     //BoundaryMode
+	int32_t width;
+	int32_t height;
+	uint64_t seed;
+	uint64_t step;         //updates completed when it was saved
+	uint64_t speciesCount; //CheckpointSpecies entries right after the header, the empty species included
+	uint64_t gridOffset;   //start of the grid's block from the start of the file
+	uint64_t gridBytes;    //AtomGrid::memoryFor(width, height)
+};
+
+static_assert(sizeof(CheckpointHeader) == 72, "the checkpoint header must not pick up padding");
+
+struct CheckpointSpecies {
+	int32_t protons;
+	int32_t neutrons;
+	int32_t electrons;
+};
+
+/* Where the grid of a checkpoint with that many species starts
+*/
+size_t checkpointGridOffset(size_t speciesCount);
+
+/* Why a checkpoint of fileBytes with this header cannot be opened by this build, nullptr when it can
+*/
+const char* checkpointProblem(const CheckpointHeader& header, size_t fileBytes);
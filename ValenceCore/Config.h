@@ -0,0 +1,29 @@
+#pragma once
+
+//default size of a universe, both front ends take the size at runtime
+const int UNIVERSE_WIDTH = 32;
+const int UNIVERSE_HEIGHT = 32;
+const int CELLS_PER_ATOM = 8; //one cell in this many draws an atom in a new layout, a ninth of those come out empty
+const int TILE_SIZE = 64; //cells along each side of a tile in the tiled update
+//keyboard mapping of UPS rates, 0 pauses and a negative rate updates as fast as the universe can
+const double UPS[10] = { 0, 1, 2, 5, 10, 30, 60, 120, 1000, -1 };
+const double MAX_FPS = 60; //frame cap of the renderer, negative leaves it to vsync
+const int KEYFRAME_INTERVAL = 100; //steps between the full frames of a recorded trajectory
+const char* const CHECKPOINT_FILE = "valence.checkpoint"; //where the Valence window saves and loads its universe
+const bool INSTRUMENT = true; //phase timers and event counters of Instrumentation.h, false compiles them out
+
+//master debug control.
+const bool DEBUG = false;
+
+//debugging options
+const bool PRINT_ATOM_INIT = true;
+const bool INCLUDE_EMPTY_INIT = false; // also prints empty atoms on init
+const bool PRINT_BOND_CALCULATION = true;
+const bool PRINT_UNIVERSE_ON_UPDATE = true;
+const bool PRINT_MOVEMENT_CALCULATION = true;
+const bool WAIT_ON_UPDATE = true;
+
+
+//rendering options
+const bool ELECTRON_SPIN = true ;
+const bool SHOW_EMPTY = false; //display atoms with no protons/neutorns/electrons with an outlined box
\ No newline at end of file
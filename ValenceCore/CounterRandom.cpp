@@ -0,0 +1,33 @@
+#include "CounterRandom.h"
+#include <chrono>
+
+//splitmix64 finalizer, every input bit affects every output bit
+static uint64_t mix(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+CounterRandom::CounterRandom(uint64_t seed, uint64_t cell, uint64_t step) {
+	this->key = mix(mix(mix(seed + GOLDEN_GAMMA) ^ cell) ^ step);
+	this->counter = 0;
+}
+
+uint64_t CounterRandom::next() {
+	this->counter++;
+	return mix(this->key + this->counter * GOLDEN_GAMMA);
+}
+
+int CounterRandom::nextInt(int bound) {
+	//scales the top 32 bits instead of taking a remainder so small bounds stay even
+	return (int)(((this->next() >> 32) * (uint64_t)bound) >> 32);
+}
+
+uint64_t randomSeed() {
+	return mix((uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
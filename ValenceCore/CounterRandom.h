@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+* Counter based random numbers keyed by (seed, cell, step)
+*
+* Every draw is a pure function of its key and how many draws came before it from the same key,
+* nothing is shared between keys. Cells can be generated in any order and on any thread,
+* and a run replays bit for bit from its seed.
+*/
+class CounterRandom {
+	uint64_t key;
+	uint64_t counter;
+
+public:
+	/* @param seed of the whole run
+	* @param cell the draws belong to
+	* @param step of the universe the draws are made in, 0 while the universe is created
+	*/
+	CounterRandom(uint64_t seed, uint64_t cell, uint64_t step);
+
+	/* 64 random bits
+	*/
+	uint64_t next();
+
+	/* Random number in [0, bound)
+	*/
+	int nextInt(int bound);
+};
+
+/* Seed for runs that are not asked to repeat, taken from the clock
+*/
+uint64_t randomSeed();
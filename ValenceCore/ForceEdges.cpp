@@ -0,0 +1,35 @@
+#include "ForceEdges.h"
+#include <cstdlib>
+
+static const size_t EDGE_ALIGNMENT = 64;
+
+static size_t alignedBytes(size_t bytes) {
+	return (bytes + EDGE_ALIGNMENT - 1) & ~(EDGE_ALIGNMENT - 1);
+}
+
+ForceEdges::ForceEdges(size_t cells) {
+	this->cellCount = cells;
+	const size_t edgeBytes = alignedBytes(cells * sizeof(force_t));
+	this->block = (unsigned char*)calloc(memoryFor(cells) + EDGE_ALIGNMENT, 1);
+	if (this->block == nullptr) {
+		std::cout << "Could not allocate force edges for " << cells << " cells" << std::endl;
+		exit(-1);
+	}
+	unsigned char* next = (unsigned char*)alignedBytes((size_t)this->block);
+	for (int e = 0; e < 4; e++) {
+		this->edge[e] = (force_t*)next;
+		next += edgeBytes;
+	}
+}
+
+ForceEdges::~ForceEdges() {
+	free(this->block);
+}
+
+size_t ForceEdges::memoryUsage() const {
+	return memoryFor(this->cellCount);
+}
+
+size_t ForceEdges::memoryFor(size_t cells) {
+	return 4 * alignedBytes(cells * sizeof(force_t));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Atom.h"
+#include <cstddef>
+
+/* Pairs a cell owns, named after where the other cell sits
+* E_RIGHT + OFP offset lines them up with F_RIGHT, F_BOTR, F_BOT, F_BOTL
+*/
+typedef enum PairEdge { E_RIGHT, E_BOTR, E_BOT, E_BOTL } PairEdge;
+
+inline OFP edgePosition(int edge) {
+	return (OFP)(F_RIGHT + edge);
+}
+
+/*
+* One force per pair of neighboring cells
+*
+* Every cell stores the pairs towards its right, bottom right, bottom and bottom left neighbors,
+* the other four sides of a cell are the same pairs stored by the neighbors on those sides.
+* A pair is measured once, written once and read back by both of its cells during the sync,
+* so nothing has to remember which side a neighbor already measured.
+*
+* A corner point is the crossing of the two diagonal pairs through it,
+* its synced force is worked out from those two edges when the lanes are gathered.
+*/
+class ForceEdges {
+	size_t cellCount;
+	unsigned char* block;
+
+public:
+	force_t* edge[4]; //one array per PairEdge, indexed by the owning cell
+
+	ForceEdges(size_t cells);
+	~ForceEdges();
+
+	ForceEdges(const ForceEdges&) = delete;
+	ForceEdges& operator=(const ForceEdges&) = delete;
+
+	/* Bytes held by the edge arrays
+	*/
+	size_t memoryUsage() const;
+
+	/* Bytes the edges of that many cells allocate
+	*/
+	static size_t memoryFor(size_t cells);
+};
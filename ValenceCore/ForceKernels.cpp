@@ -0,0 +1,270 @@
+#include "ForceKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VALENCE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//gcc and clang only emit instructions outside the build's target for functions marked with them
+#if defined(__GNUC__)
+#define VALENCE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VALENCE_TARGET(isa)
+#endif
+
+static inline int8_t direction(force_t force) {
+	return force > 0 ? 1 : (force < 0 ? -1 : 0);
+}
+
+static void syncRowScalar(const force_t* const edge[4], force_t* const force[8], size_t stride, size_t begin, size_t end) {
+	const force_t quarter = (force_t)0.25;
+	const force_t* botR = edge[E_BOTR];
+	const force_t* botL = edge[E_BOTL];
+	for (size_t c = begin; c < end; c++) {
+		force[F_TOP][c] = edge[E_BOT][c - stride];
+		force[F_RIGHT][c] = edge[E_RIGHT][c];
+		force[F_BOT][c] = edge[E_BOT][c];
+		force[F_LEFT][c] = edge[E_RIGHT][c - 1];
+		//away from the border the top left cell of a corner point always reaches it first
+		force_t pA = botR[c - stride - 1], pB = botL[c - stride];
+		force[F_TOPL][c] = (pA + pA + pB + pB) * quarter;
+		pA = botR[c - stride], pB = botL[c - stride + 1];
+		force[F_TOPR][c] = (pA + pA + pB + pB) * quarter;
+		pA = botR[c - 1], pB = botL[c];
+		force[F_BOTL][c] = (pA + pA + pB + pB) * quarter;
+		pA = botR[c], pB = botL[c + 1];
+		force[F_BOTR][c] = (pA + pA + pB + pB) * quarter;
+	}
+}
+
+static void netForceRowScalar(const force_t* const force[8], size_t begin, size_t end, NetForce* net) {
+	for (size_t c = begin; c < end; c++) {
+		net[c] = netForceOf(force[F_TOPL][c], force[F_TOP][c], force[F_TOPR][c], force[F_RIGHT][c],
+			force[F_BOTR][c], force[F_BOT][c], force[F_BOTL][c], force[F_LEFT][c]);
+	}
+}
+
+#ifdef VALENCE_X86
+
+/* The vector kernels are written once against these wrappers,
+* a register holds 2 or 4 doubles (SSE2 / AVX) or 4 or 8 floats in a compact build
+*/
+#ifdef VALENCE_COMPACT
+typedef __m128 SseVector;
+typedef __m256 AvxVector;
+VALENCE_TARGET("sse2") static inline SseVector sseLoad(const force_t* p) { return _mm_loadu_ps(p); }
+VALENCE_TARGET("sse2") static inline void sseStore(force_t* p, SseVector v) { _mm_storeu_ps(p, v); }
+VALENCE_TARGET("sse2") static inline SseVector sseAdd(SseVector a, SseVector b) { return _mm_add_ps(a, b); }
+VALENCE_TARGET("sse2") static inline SseVector sseMul(SseVector a, SseVector b) { return _mm_mul_ps(a, b); }
+VALENCE_TARGET("sse2") static inline SseVector sseSet(force_t v) { return _mm_set1_ps(v); }
+VALENCE_TARGET("avx") static inline AvxVector avxLoad(const force_t* p) { return _mm256_loadu_ps(p); }
+VALENCE_TARGET("avx") static inline void avxStore(force_t* p, AvxVector v) { _mm256_storeu_ps(p, v); }
+VALENCE_TARGET("avx") static inline AvxVector avxAdd(AvxVector a, AvxVector b) { return _mm256_add_ps(a, b); }
+VALENCE_TARGET("avx") static inline AvxVector avxMul(AvxVector a, AvxVector b) { return _mm256_mul_ps(a, b); }
+VALENCE_TARGET("avx") static inline AvxVector avxSet(force_t v) { return _mm256_set1_ps(v); }
+#else
+typedef __m128d SseVector;
+typedef __m256d AvxVector;
+VALENCE_TARGET("sse2") static inline SseVector sseLoad(const force_t* p) { return _mm_loadu_pd(p); }
+VALENCE_TARGET("sse2") static inline void sseStore(force_t* p, SseVector v) { _mm_storeu_pd(p, v); }
+VALENCE_TARGET("sse2") static inline SseVector sseAdd(SseVector a, SseVector b) { return _mm_add_pd(a, b); }
+VALENCE_TARGET("sse2") static inline SseVector sseMul(SseVector a, SseVector b) { return _mm_mul_pd(a, b); }
+VALENCE_TARGET("sse2") static inline SseVector sseSet(force_t v) { return _mm_set1_pd(v); }
+VALENCE_TARGET("avx") static inline AvxVector avxLoad(const force_t* p) { return _mm256_loadu_pd(p); }
+VALENCE_TARGET("avx") static inline void avxStore(force_t* p, AvxVector v) { _mm256_storeu_pd(p, v); }
+VALENCE_TARGET("avx") static inline AvxVector avxAdd(AvxVector a, AvxVector b) { return _mm256_add_pd(a, b); }
+VALENCE_TARGET("avx") static inline AvxVector avxMul(AvxVector a, AvxVector b) { return _mm256_mul_pd(a, b); }
+VALENCE_TARGET("avx") static inline AvxVector avxSet(force_t v) { return _mm256_set1_pd(v); }
+#endif
+
+static const size_t SSE_LANES = sizeof(SseVector) / sizeof(force_t);
+static const size_t AVX_LANES = sizeof(AvxVector) / sizeof(force_t);
+
+VALENCE_TARGET("sse2")
+static inline SseVector cornerSse2(const force_t* botR, const force_t* botL) {
+	SseVector pA = sseLoad(botR);
+	SseVector pB = sseLoad(botL);
+	SseVector sum = sseAdd(sseAdd(sseAdd(pA, pA), pB), pB);
+	return sseMul(sum, sseSet((force_t)0.25));
+}
+
+VALENCE_TARGET("sse2")
+static void syncRowSse2(const force_t* const edge[4], force_t* const force[8], size_t stride, size_t begin, size_t end) {
+	const force_t* botR = edge[E_BOTR];
+	const force_t* botL = edge[E_BOTL];
+	size_t c = begin;
+	for (; c + SSE_LANES <= end; c += SSE_LANES) {
+		sseStore(force[F_TOP] + c, sseLoad(edge[E_BOT] + c - stride));
+		sseStore(force[F_RIGHT] + c, sseLoad(edge[E_RIGHT] + c));
+		sseStore(force[F_BOT] + c, sseLoad(edge[E_BOT] + c));
+		sseStore(force[F_LEFT] + c, sseLoad(edge[E_RIGHT] + c - 1));
+		sseStore(force[F_TOPL] + c, cornerSse2(botR + c - stride - 1, botL + c - stride));
+		sseStore(force[F_TOPR] + c, cornerSse2(botR + c - stride, botL + c - stride + 1));
+		sseStore(force[F_BOTL] + c, cornerSse2(botR + c - 1, botL + c));
+		sseStore(force[F_BOTR] + c, cornerSse2(botR + c, botL + c + 1));
+	}
+	syncRowScalar(edge, force, stride, c, end);
+}
+
+VALENCE_TARGET("sse2")
+static void netForceRowSse2(const force_t* const force[8], size_t begin, size_t end, NetForce* net) {
+	const SseVector negative = sseSet(-1);
+	size_t c = begin;
+	for (; c + SSE_LANES <= end; c += SSE_LANES) {
+		SseVector topL = sseLoad(force[F_TOPL] + c), top = sseLoad(force[F_TOP] + c);
+		SseVector topR = sseLoad(force[F_TOPR] + c), right = sseLoad(force[F_RIGHT] + c);
+		SseVector botR = sseLoad(force[F_BOTR] + c), bot = sseLoad(force[F_BOT] + c);
+		SseVector botL = sseLoad(force[F_BOTL] + c), left = sseLoad(force[F_LEFT] + c);
+		SseVector horizontal = sseAdd(sseAdd(sseAdd(topL, left), botL),
+			sseMul(sseAdd(sseAdd(topR, right), botR), negative));
+		SseVector vertical = sseAdd(sseAdd(sseAdd(topL, top), topR),
+			sseMul(sseAdd(sseAdd(botL, bot), botR), negative));
+		force_t h[SSE_LANES], v[SSE_LANES];
+		sseStore(h, horizontal);
+		sseStore(v, vertical);
+		for (size_t k = 0; k < SSE_LANES; k++) {
+			NetForce& out = net[c + k];
+			out.horizontal = h[k];
+			out.vertical = v[k];
+			out.dx = direction(h[k]);
+			out.dy = direction(v[k]);
+		}
+	}
+	netForceRowScalar(force, c, end, net);
+}
+
+VALENCE_TARGET("avx")
+static inline AvxVector cornerAvx(const force_t* botR, const force_t* botL) {
+	AvxVector pA = avxLoad(botR);
+	AvxVector pB = avxLoad(botL);
+	AvxVector sum = avxAdd(avxAdd(avxAdd(pA, pA), pB), pB);
+	return avxMul(sum, avxSet((force_t)0.25));
+}
+
+VALENCE_TARGET("avx")
+static void syncRowAvx(const force_t* const edge[4], force_t* const force[8], size_t stride, size_t begin, size_t end) {
+	const force_t* botR = edge[E_BOTR];
+	const force_t* botL = edge[E_BOTL];
+	size_t c = begin;
+	for (; c + AVX_LANES <= end; c += AVX_LANES) {
+		avxStore(force[F_TOP] + c, avxLoad(edge[E_BOT] + c - stride));
+		avxStore(force[F_RIGHT] + c, avxLoad(edge[E_RIGHT] + c));
+		avxStore(force[F_BOT] + c, avxLoad(edge[E_BOT] + c));
+		avxStore(force[F_LEFT] + c, avxLoad(edge[E_RIGHT] + c - 1));
+		avxStore(force[F_TOPL] + c, cornerAvx(botR + c - stride - 1, botL + c - stride));
+		avxStore(force[F_TOPR] + c, cornerAvx(botR + c - stride, botL + c - stride + 1));
+		avxStore(force[F_BOTL] + c, cornerAvx(botR + c - 1, botL + c));
+		avxStore(force[F_BOTR] + c, cornerAvx(botR + c, botL + c + 1));
+	}
+	syncRowScalar(edge, force, stride, c, end);
+}
+
+VALENCE_TARGET("avx")
+static void netForceRowAvx(const force_t* const force[8], size_t begin, size_t end, NetForce* net) {
+	const AvxVector negative = avxSet(-1);
+	size_t c = begin;
+	for (; c + AVX_LANES <= end; c += AVX_LANES) {
+		AvxVector topL = avxLoad(force[F_TOPL] + c), top = avxLoad(force[F_TOP] + c);
+		AvxVector topR = avxLoad(force[F_TOPR] + c), right = avxLoad(force[F_RIGHT] + c);
+		AvxVector botR = avxLoad(force[F_BOTR] + c), bot = avxLoad(force[F_BOT] + c);
+		AvxVector botL = avxLoad(force[F_BOTL] + c), left = avxLoad(force[F_LEFT] + c);
+		AvxVector horizontal = avxAdd(avxAdd(avxAdd(topL, left), botL),
+			avxMul(avxAdd(avxAdd(topR, right), botR), negative));
+		AvxVector vertical = avxAdd(avxAdd(avxAdd(topL, top), topR),
+			avxMul(avxAdd(avxAdd(botL, bot), botR), negative));
+		force_t h[AVX_LANES], v[AVX_LANES];
+		avxStore(h, horizontal);
+		avxStore(v, vertical);
+		for (size_t k = 0; k < AVX_LANES; k++) {
+			NetForce& out = net[c + k];
+			out.horizontal = h[k];
+			out.vertical = v[k];
+			out.dx = direction(h[k]);
+			out.dy = direction(v[k]);
+		}
+	}
+	netForceRowScalar(force, c, end, net);
+}
+
+static void cpuid(int leaf, int registers[4]) {
+#ifdef _MSC_VER
+	__cpuid(registers, leaf);
+#else
+	unsigned int a, b, c, d;
+	__asm__ __volatile__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(leaf), "c"(0));
+	registers[0] = (int)a;
+	registers[1] = (int)b;
+	registers[2] = (int)c;
+	registers[3] = (int)d;
+#endif
+}
+
+//which register state the OS saves on a context switch
+static unsigned long long xgetbv0() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int low, high;
+	__asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return ((unsigned long long)high << 32) | low;
+#endif
+}
+
+SimdLevel detectSimdLevel() {
+	int registers[4];
+	cpuid(0, registers);
+	if (registers[0] < 1) {
+		return SIMD_SCALAR;
+	}
+	cpuid(1, registers);
+	const bool sse2 = (registers[3] >> 26) & 1;
+	const bool osxsave = (registers[2] >> 27) & 1;
+	const bool avx = (registers[2] >> 28) & 1;
+	if (avx && osxsave && (xgetbv0() & 0x6) == 0x6) {
+		return SIMD_AVX;
+	}
+	return sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+}
+
+#else
+
+SimdLevel detectSimdLevel() {
+	return SIMD_SCALAR;
+}
+
+#endif
+
+const char* simdLevelName(SimdLevel level) {
+	switch (level) {
+	case SIMD_SCALAR:
+		return "scalar";
+	case SIMD_SSE2:
+		return "sse2";
+	case SIMD_AVX:
+		return "avx";
+	default:
+		return "best";
+	}
+}
+
+const ForceKernels& forceKernels(SimdLevel level) {
+	static const ForceKernels scalar = { SIMD_SCALAR, syncRowScalar, netForceRowScalar };
+#ifdef VALENCE_X86
+	static const ForceKernels sse2 = { SIMD_SSE2, syncRowSse2, netForceRowSse2 };
+	static const ForceKernels avx = { SIMD_AVX, syncRowAvx, netForceRowAvx };
+	static const SimdLevel supported = detectSimdLevel();
+	if (level > supported) {
+		level = supported;
+	}
+	if (level == SIMD_AVX) {
+		return avx;
+	}
+	if (level == SIMD_SSE2) {
+		return sse2;
+	}
+#endif
+	return scalar;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "NetForce.h"
+#include "ForceEdges.h"
+#include <cstddef>
+
+/* Instruction sets the force kernels are written for
+* SIMD_BEST picks the widest one the running CPU supports
+*/
+typedef enum SimdLevel { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX, SIMD_BEST } SimdLevel;
+
+/*
+* Row kernels for the passes that only do fixed arithmetic on the force lanes
+*
+* syncRow finishes the sync for cells [begin, end) of one row whose neighbors are all inside
+* the universe (1 <= y <= size - 2 and 1 <= x <= size - 2): the lanes are gathered from the
+* pair forces around the cell, corners become the average of the two pairs crossing at that point.
+* netForceRow fills the NetForce of cells [begin, end) from their synced lanes.
+*
+* All versions do the same operations in the same order, so the SIMD kernels
+* give bit for bit the same results as the scalar ones.
+*/
+struct ForceKernels {
+	SimdLevel level;
+
+	/* @param edge measured pair forces, see ForceEdges
+	* @param force synced lanes written for [begin, end)
+	* @param stride cells per row
+	*/
+	void (*syncRow)(const force_t* const edge[4], force_t* const force[8], size_t stride, size_t begin, size_t end);
+
+	void (*netForceRow)(const force_t* const force[8], size_t begin, size_t end, NetForce* net);
+};
+
+/* Widest instruction set the running CPU (and OS) supports
+*/
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+/* Kernels for level, falling back to the widest supported one below it
+*/
+const ForceKernels& forceKernels(SimdLevel level = SIMD_BEST);
@@ -0,0 +1,91 @@
+#include "Instrumentation.h"
+
+Instrumentation::Instrumentation() {
+	this->reset();
+}
+
+InstrumentSample Instrumentation::sample() const {
+	InstrumentSample out;
+	for (int t = 0; t < PT_COUNT; t++) {
+		out.nanos[t] = this->nanos[t].load(std::memory_order_relaxed);
+		out.calls[t] = this->calls[t].load(std::memory_order_relaxed);
+	}
+	for (int c = 0; c < EC_COUNT; c++) {
+		out.counts[c] = this->counts[c].load(std::memory_order_relaxed);
+	}
+	return out;
+}
+
+void Instrumentation::reset() {
+	for (int t = 0; t < PT_COUNT; t++) {
+		this->nanos[t].store(0, std::memory_order_relaxed);
+		this->calls[t].store(0, std::memory_order_relaxed);
+	}
+	for (int c = 0; c < EC_COUNT; c++) {
+		this->counts[c].store(0, std::memory_order_relaxed);
+	}
+}
+
+const char* Instrumentation::timerName(PhaseTimer timer) {
+	switch (timer) {
+	case PT_UPDATE: return "update";
+	case PT_PRESSURE: return "pressure";
+	case PT_SYNC: return "sync";
+	case PT_MOVE: return "move";
+	case PT_DRAW: return "draw";
+	case PT_PRESENT: return "present";
+	default: return "unknown";
+	}
+}
+
+const char* Instrumentation::counterName(EventCounter counter) {
+	switch (counter) {
+	case EC_MOVES: return "moves";
+	case EC_BLOCKED_MOVES: return "blocked_moves";
+	case EC_FAILED_CLAIMS: return "failed_claims";
+	case EC_IONIC_PAIRS: return "ionic_pairs";
+	case EC_COVALENT_PAIRS: return "covalent_pairs";
+	case EC_REPULSIVE_PAIRS: return "repulsive_pairs";
+	default: return "unknown";
+	}
+}
+
+void Instrumentation::writeCsvHeader(std::ostream& out) {
+	out << "step";
+	for (int t = 0; t < PT_COUNT; t++) {
+		out << "," << timerName((PhaseTimer)t) << "_ms," << timerName((PhaseTimer)t) << "_calls";
+	}
+	for (int c = 0; c < EC_COUNT; c++) {
+		out << "," << counterName((EventCounter)c);
+	}
+	out << "\n";
+}
+
+void Instrumentation::writeCsv(std::ostream& out, uint64_t step, const InstrumentSample& sample) {
+	out << step;
+	for (int t = 0; t < PT_COUNT; t++) {
+		out << "," << sample.nanos[t] / 1e6 << "," << sample.calls[t];
+	}
+	for (int c = 0; c < EC_COUNT; c++) {
+		out << "," << sample.counts[c];
+	}
+	out << "\n";
+}
+
+void Instrumentation::writeJson(std::ostream& out, uint64_t step, const InstrumentSample& sample) {
+	out << "{\"step\":" << step << ",\"phases\":{";
+	for (int t = 0; t < PT_COUNT; t++) {
+		out << (t == 0 ? "" : ",") << "\"" << timerName((PhaseTimer)t) << "\":{\"ms\":" << sample.nanos[t] / 1e6
+			<< ",\"calls\":" << sample.calls[t] << "}";
+	}
+	out << "},\"counts\":{";
+	for (int c = 0; c < EC_COUNT; c++) {
+		out << (c == 0 ? "" : ",") << "\"" << counterName((EventCounter)c) << "\":" << sample.counts[c];
+	}
+	out << "}}\n";
+}
+
+Instrumentation& instruments() {
+	static Instrumentation shared;
+	return shared;
+}
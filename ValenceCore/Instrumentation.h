@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/* Phases timed while the universe runs
+* PT_UPDATE is all of Universe::update, the fused engine interleaves the other update phases row by row
+* so it only reports PT_UPDATE. PT_DRAW and PT_PRESENT are timed by the Valence window.
+*/
+typedef enum PhaseTimer { PT_UPDATE, PT_PRESSURE, PT_SYNC, PT_MOVE, PT_DRAW, PT_PRESENT, PT_COUNT } PhaseTimer;
+
+/* Events counted while the universe runs
+* a blocked move points at a wall or an atom, an outbid move lost its cell to a stronger claim.
+* Bonds are counted for every pair measured, so an incremental update only counts the pairs it measured again.
+*/
+typedef enum EventCounter {
+	EC_MOVES, EC_BLOCKED_MOVES, EC_FAILED_CLAIMS, EC_IONIC_PAIRS, EC_COVALENT_PAIRS, EC_REPULSIVE_PAIRS, EC_COUNT
+} EventCounter;
+
+/* Totals since the last reset
+*/
+struct InstrumentSample {
+	uint64_t nanos[PT_COUNT]; //time spent in each phase
+	uint64_t calls[PT_COUNT]; //times each phase ran
+	uint64_t counts[EC_COUNT];
+};
+
+/*
+* Process wide phase timers and event counters, see instruments()
+*
+* Everything is a relaxed atomic total, the update adds each tile's tally once per phase.
+* With INSTRUMENT set to false in Config.h every timer and count is a constant false branch
+* the compiler drops, the totals stay at 0.
+*/
+class Instrumentation {
+	std::atomic<uint64_t> nanos[PT_COUNT];
+	std::atomic<uint64_t> calls[PT_COUNT];
+	std::atomic<uint64_t> counts[EC_COUNT];
+
+public:
+	Instrumentation();
+
+	void addTime(PhaseTimer timer, uint64_t elapsed);
+	void count(EventCounter counter, uint64_t events);
+
+	InstrumentSample sample() const;
+	void reset();
+
+	static const char* timerName(PhaseTimer timer);
+	static const char* counterName(EventCounter counter);
+
+	/* Column names of writeCsv, starting with step
+	*/
+	static void writeCsvHeader(std::ostream& out);
+
+	/* One line per sample, times in milliseconds
+	* @param step updates completed when the sample was taken
+	*/
+	static void writeCsv(std::ostream& out, uint64_t step, const InstrumentSample& sample);
+	static void writeJson(std::ostream& out, uint64_t step, const InstrumentSample& sample);
+};
+
+/* Instruments shared by every universe and front end in the process
+*/
+Instrumentation& instruments();
+
+/* Adds the time from construction to destruction to a phase
+*/
+class PhaseClock {
+	PhaseTimer timer;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	explicit PhaseClock(PhaseTimer timer);
+	~PhaseClock();
+
+	PhaseClock(const PhaseClock&) = delete;
+	PhaseClock& operator=(const PhaseClock&) = delete;
+};
+
+inline void Instrumentation::addTime(PhaseTimer timer, uint64_t elapsed) {
+	this->nanos[timer].fetch_add(elapsed, std::memory_order_relaxed);
+	this->calls[timer].fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void Instrumentation::count(EventCounter counter, uint64_t events) {
+	if (events != 0) {
+		this->counts[counter].fetch_add(events, std::memory_order_relaxed);
+	}
+}
+
+inline PhaseClock::PhaseClock(PhaseTimer timer) {
+	this->timer = timer;
+	if (INSTRUMENT) {
+		this->start = std::chrono::steady_clock::now();
+	}
+}
+
+inline PhaseClock::~PhaseClock() {
+	if (INSTRUMENT) {
+		auto elapsed = std::chrono::steady_clock::now() - this->start;
+		instruments().addTime(this->timer, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+}
@@ -0,0 +1,113 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <cstring>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+#ifdef _WIN32
+
+static std::string fullPathOf(const std::string& path) {
+	char full[MAX_PATH];
+	DWORD length = GetFullPathNameA(path.c_str(), MAX_PATH, full, nullptr);
+	return length == 0 || length >= MAX_PATH ? path : std::string(full, length);
+}
+
+MappedFile::MappedFile(const std::string& path) {
+	this->bytes = nullptr;
+	this->byteCount = 0;
+	this->mapping = nullptr;
+	this->fullPath = fullPathOf(path);
+	this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->file == INVALID_HANDLE_VALUE) {
+		this->file = nullptr;
+		return;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(this->file, &size) || size.QuadPart == 0) {
+		return;
+	}
+	//PAGE_WRITECOPY gives each page a private copy the first time it is written
+	this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (this->mapping == nullptr) {
+		return;
+	}
+	this->bytes = (unsigned char*)MapViewOfFile(this->mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (this->bytes != nullptr) {
+		this->byteCount = (size_t)size.QuadPart;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (this->bytes != nullptr) {
+		UnmapViewOfFile(this->bytes);
+	}
+	if (this->mapping != nullptr) {
+		CloseHandle(this->mapping);
+	}
+	if (this->file != nullptr) {
+		CloseHandle(this->file);
+	}
+}
+
+bool MappedFile::isFile(const std::string& path) const {
+	//paths on Windows ignore case
+	return this->file != nullptr && _stricmp(this->fullPath.c_str(), fullPathOf(path).c_str()) == 0;
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+	this->bytes = nullptr;
+	this->byteCount = 0;
+	this->device = 0;
+	this->inode = 0;
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return;
+	}
+	struct stat status;
+	if (fstat(file, &status) == 0 && status.st_size > 0) {
+		this->device = (unsigned long long)status.st_dev;
+		this->inode = (unsigned long long)status.st_ino;
+		//MAP_PRIVATE gives each page a private copy the first time it is written
+		void* mapped = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		if (mapped != MAP_FAILED) {
+			this->bytes = (unsigned char*)mapped;
+			this->byteCount = (size_t)status.st_size;
+		}
+	}
+	//the mapping keeps the file alive on its own
+	close(file);
+}
+
+MappedFile::~MappedFile() {
+	if (this->bytes != nullptr) {
+		munmap(this->bytes, this->byteCount);
+	}
+}
+
+bool MappedFile::isFile(const std::string& path) const {
+	struct stat status;
+	return this->bytes != nullptr && stat(path.c_str(), &status) == 0
+		&& (unsigned long long)status.st_dev == this->device && (unsigned long long)status.st_ino == this->inode;
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+	//rename swaps the directory entry atomically, whatever still maps the old file keeps it
+	return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+#endif
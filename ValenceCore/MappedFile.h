@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+* A whole file mapped into memory copy on write
+*
+* Pages are read from the file the first time they are touched and writes stay private to the process,
+* so whatever was mapped can be used and changed like any other memory while the file on disk is left alone.
+* The mapping lives until the object is destroyed.
+*/
+class MappedFile {
+	unsigned char* bytes;
+	size_t byteCount;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+	std::string fullPath; //what the path resolved to when it was mapped
+#else
+	unsigned long long device; //identity of the mapped file, st_dev and st_ino
+	unsigned long long inode;
+#endif
+
+public:
+	/* Maps the file at path, isOpen tells whether that worked
+	*/
+	MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool isOpen() const;
+
+	/* First byte of the file, aligned to a page
+	*/
+	unsigned char* data() const;
+	size_t size() const;
+
+	/* Whether path names the file that is mapped
+	*/
+	bool isFile(const std::string& path) const;
+};
+
+/* True where a file cannot be replaced while it is mapped, anything mapped from it has to let go first
+*/
+#ifdef _WIN32
+const bool MAPPING_LOCKS_FILE = true;
+#else
+const bool MAPPING_LOCKS_FILE = false;
+#endif
+
+/* Moves the file at from over the file at to in one step, to is either the old or the new file at any moment
+* @return false when to was left as it was
+*/
+bool replaceFile(const std::string& from, const std::string& to);
+
+inline bool MappedFile::isOpen() const {
+	return this->bytes != nullptr;
+}
+
+inline unsigned char* MappedFile::data() const {
+	return this->bytes;
+}
+
+inline size_t MappedFile::size() const {
+	return this->byteCount;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Atom.h"
+#include <cstdint>
+
+/*
+* Net force on a cell once its outer forces are synced
+*
+* Worked out once per cell per update right after the sync so the move phase
+* never goes back to the eight outer force lanes.
+*/
+struct NetForce {
+	force_t horizontal; //left-/right+
+	force_t vertical;   //top-/bottom+
+	int8_t dx;         //simple horizontal force -1/0/1 used for movement on the grid
+	int8_t dy;         //simple vertical force -1/0/1 used for movement on the grid
+};
+
+/* Net force from the 8 outer forces of a cell
+*/
+inline NetForce netForceOf(force_t topL, force_t top, force_t topR, force_t right, force_t botR, force_t bot, force_t botL, force_t left) {
+	NetForce net;
+	net.horizontal = (topL + left + botL) + ((topR + right + botR) * -1);
+	net.vertical = (topL + top + topR) + ((botL + bot + botR) * -1);
+	net.dx = net.horizontal > 0 ? 1 : (net.horizontal < 0 ? -1 : 0);
+	net.dy = net.vertical > 0 ? 1 : (net.vertical < 0 ? -1 : 0);
+	return net;
+}
+
+/* Force the cell applies towards its neighbor at position
+*/
+inline force_t forceTowards(const NetForce& net, OFP position) {
+	switch (position) {
+	case F_TOPL:
+		return -1 * (net.vertical + net.horizontal) / 2;
+	case F_TOP:
+		return -1 * net.vertical;
+	case F_TOPR:
+		return (net.horizontal - net.vertical) / 2;
+	case F_RIGHT:
+		return net.horizontal;
+	case F_BOTR:
+		return (net.vertical + net.horizontal) / 2;
+	case F_BOT:
+		return net.vertical;
+	case F_BOTL:
+		return (net.vertical - net.horizontal) / 2;
+	case F_LEFT:
+		return -1 * net.horizontal;
+	default:
+		return 0;
+	}
+}
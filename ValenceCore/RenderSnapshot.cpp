@@ -0,0 +1,72 @@
+#include "RenderSnapshot.h"
+#include <algorithm>
+
+RenderSnapshot::RenderSnapshot() {
+	this->width = this->height = 0;
+	this->step = 0;
+}
+
+void RenderSnapshot::buildLevels() {
+	int levelCount = 0;
+	for (int side = 2; side / 2 < std::max(this->width, this->height); side *= 2) {
+		levelCount++;
+	}
+	this->levels.resize(levelCount);
+	for (int l = 0; l < levelCount; l++) {
+		BlockLevel& level = this->levels[l];
+		level.side = 2 << l;
+		level.columns = (this->width + level.side - 1) / level.side;
+		level.rows = (this->height + level.side - 1) / level.side;
+		level.blocks.assign((size_t)level.columns * level.rows, BlockView());
+		//the 2x2 cells or blocks below each block, clipped at the edge of the universe
+		int belowColumns = l == 0 ? this->width : this->levels[l - 1].columns;
+		int belowRows = l == 0 ? this->height : this->levels[l - 1].rows;
+		for (int y = 0; y < level.rows; y++) {
+			for (int x = 0; x < level.columns; x++) {
+				BlockView& block = level.blocks[(size_t)y * level.columns + x];
+				for (int dy = 0; dy < 2 && y * 2 + dy < belowRows; dy++) {
+					for (int dx = 0; dx < 2 && x * 2 + dx < belowColumns; dx++) {
+						if (l == 0) {
+							const CellView& cell = this->at(y * 2 + dy, x * 2 + dx);
+							block.atoms += cell.isEmpty() ? 0 : 1;
+							block.protons += cell.protons;
+						}
+						else {
+							const BlockView& part = this->levels[l - 1].at(y * 2 + dy, x * 2 + dx);
+							block.atoms += part.atoms;
+							block.protons += part.protons;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+SnapshotExchange::SnapshotExchange() {
+	this->back = 0;
+	this->middle = 1;
+	this->front = 2;
+}
+
+RenderSnapshot& SnapshotExchange::writeBuffer() {
+	return this->buffers[this->back];
+}
+
+void SnapshotExchange::publish() {
+	//release makes the writes to the buffer visible to the reader that acquires it
+	int previous = this->middle.exchange(this->back | FRESH, std::memory_order_acq_rel);
+	this->back = previous & INDEX;
+}
+
+bool SnapshotExchange::pending() const {
+	return (this->middle.load(std::memory_order_relaxed) & FRESH) != 0;
+}
+
+const RenderSnapshot& SnapshotExchange::latest() {
+	if (this->middle.load(std::memory_order_relaxed) & FRESH) {
+		int previous = this->middle.exchange(this->front, std::memory_order_acq_rel);
+		this->front = previous & INDEX;
+	}
+	return this->buffers[this->front];
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "SpeciesTable.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/* What a front end needs to draw one cell
+*/
+struct CellView {
+	uint16_t protons;
+	uint16_t neutrons;
+	SpeciesId species; //EMPTY_SPECIES for empty cells
+	uint8_t valence;   //bit i set when valence position i holds an electron
+
+	bool isEmpty() const;
+	bool hasValenceAt(int position) const;
+};
+
+/* Summary of a square block of cells for drawing a universe zoomed out
+*/
+struct BlockView {
+	uint32_t atoms;   //cells holding an atom
+	uint32_t protons; //protons of all those atoms together
+};
+
+/* Every block of one size, row by row
+* side cells along each side of a block, columns x rows blocks cover the universe
+*/
+struct BlockLevel {
+	int side;
+	int columns;
+	int rows;
+	std::vector<BlockView> blocks;
+
+	const BlockView& at(int y, int x) const;
+};
+
+/*
+* Immutable picture of a universe after a finished update
+*
+* Filled by Universe::writeSnapshot on the update thread and only read once published,
+* it holds copies so drawing it never touches the universe.
+*/
+struct RenderSnapshot {
+	int width;     //cells along each row, 0 until the first snapshot is published
+	int height;    //rows of cells
+	uint64_t step; //updates the universe had completed
+	std::vector<CellView> cells; //row by row, width * height
+	std::vector<BlockLevel> levels; //blocks of 2, 4, 8... cells until one block covers the universe
+
+	RenderSnapshot();
+
+	const CellView& at(int y, int x) const;
+
+	/* Fills levels from cells, each level is added up from the one below it
+	* so the whole pyramid costs about a third of a pass over the cells
+	*/
+	void buildLevels();
+};
+
+/*
+* Triple buffered handoff of snapshots from the update thread to the render thread
+*
+* The writer fills its own buffer and swaps it with the shared middle one, the reader swaps
+* its buffer with the middle one when a newer snapshot is waiting. Both swaps are a single
+* atomic exchange, so neither thread ever waits for the other and a buffer is never read
+* while it is being written. Snapshots the reader did not get to in time are skipped.
+*
+* Exactly one thread may write and one thread may read.
+*/
+class SnapshotExchange {
+	RenderSnapshot buffers[3];
+	int back;  //owned by the writer
+	int front; //owned by the reader
+	std::atomic<int> middle; //index of the shared buffer, FRESH is set until the reader takes it
+
+	static const int FRESH = 4;
+	static const int INDEX = 3;
+
+public:
+	SnapshotExchange();
+
+	SnapshotExchange(const SnapshotExchange&) = delete;
+	SnapshotExchange& operator=(const SnapshotExchange&) = delete;
+
+	/* Buffer for the writer to fill, valid until the next publish
+	*/
+	RenderSnapshot& writeBuffer();
+
+	/* Hands the filled write buffer to the reader
+	*/
+	void publish();
+
+	/* Whether the last published snapshot has not been taken by the reader yet
+	*/
+	bool pending() const;
+
+	/* Newest published snapshot, valid until the next call to latest
+	* returns the same snapshot again when nothing newer was published
+	*/
+	const RenderSnapshot& latest();
+};
+
+inline bool CellView::isEmpty() const {
+	return this->species == EMPTY_SPECIES;
+}
+
+inline bool CellView::hasValenceAt(int position) const {
+	return (this->valence >> (position % 8)) & 1;
+}
+
+inline const BlockView& BlockLevel::at(int y, int x) const {
+	return this->blocks[(size_t)y * this->columns + x];
+}
+
+inline const CellView& RenderSnapshot::at(int y, int x) const {
+	return this->cells[(size_t)y * this->width + x];
+}
@@ -0,0 +1,72 @@
+#include "SpeciesTable.h"
+#include <iostream>
+
+SpeciesTable::SpeciesTable() {
+	this->capacity = 16;
+	this->pairs.assign(this->capacity * this->capacity, 0);
+	this->bonds.assign(this->capacity * this->capacity, PB_NONE);
+	this->species.push_back(Atom());
+	this->ids[keyOf(Atom())] = EMPTY_SPECIES;
+}
+
+uint64_t SpeciesTable::keyOf(const Atom& atom) {
+	return ((uint64_t)(uint16_t)atom.getProtons() << 48) | ((uint64_t)(uint16_t)atom.getNeutrons() << 32)
+		| ((uint64_t)(uint16_t)atom.getElectrons() << 16) | (uint64_t)(uint16_t)atom.getValenceElectrons();
+}
+
+double SpeciesTable::measure(const Atom& a, const Atom& b, PairBond& bond) {
+	if (a.isEmpty() || b.isEmpty()) {
+		bond = PB_NONE;
+		return 0;
+	}
+	return a.measureOuterPressure(&b, &bond);
+}
+
+void SpeciesTable::grow() {
+	size_t newCapacity = this->capacity * 2;
+	std::vector<force_t> newPairs(newCapacity * newCapacity, 0);
+	std::vector<uint8_t> newBonds(newCapacity * newCapacity, PB_NONE);
+	for (size_t a = 0; a < this->species.size(); a++) {
+		for (size_t b = 0; b < this->species.size(); b++) {
+			newPairs[a * newCapacity + b] = this->pairs[a * this->capacity + b];
+			newBonds[a * newCapacity + b] = this->bonds[a * this->capacity + b];
+		}
+	}
+	this->pairs.swap(newPairs);
+	this->bonds.swap(newBonds);
+	this->capacity = newCapacity;
+}
+
+SpeciesId SpeciesTable::idOf(const Atom& atom) {
+	uint64_t key = keyOf(atom);
+	auto found = this->ids.find(key);
+	if (found != this->ids.end()) {
+		return found->second;
+	}
+	if (this->species.size() > 0xFFFF) {
+		std::cout << "Too many species in one universe" << std::endl;
+		exit(-1);
+	}
+	SpeciesId id = (SpeciesId)this->species.size();
+	Atom composition;
+	composition.setValue(&atom);
+	this->species.push_back(composition);
+	this->ids[key] = id;
+	if (this->species.size() > this->capacity) {
+		this->grow();
+	}
+	for (size_t other = 0; other <= id; other++) {
+		const Atom& b = this->species[other];
+		PairBond bond;
+		this->pairs[id * this->capacity + other] = (force_t)measure(composition, b, bond);
+		this->bonds[id * this->capacity + other] = (uint8_t)bond;
+		this->pairs[other * this->capacity + id] = (force_t)measure(b, composition, bond);
+		this->bonds[other * this->capacity + id] = (uint8_t)bond;
+	}
+	return id;
+}
+
+size_t SpeciesTable::count() const {
+	return this->species.size();
+}
+
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Atom.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef uint16_t SpeciesId;
+
+//species of a cell holding no protons, neutrons or electrons
+const SpeciesId EMPTY_SPECIES = 0;
+
+/*
+* Every distinct (protons, neutrons, electrons) combination living in a universe
+*
+* The force two neighbors apply on each other only depends on their composition,
+* so it is measured once per ordered pair of species and looked up from then on.
+* Registering a new species (a new layout, an edit, decay) grows the table and
+* measures the new row and column, lookups never compute anything.
+*
+* Registering is not thread safe, it must happen outside of Universe::update.
+*/
+class SpeciesTable {
+	std::vector<Atom> species; //composition of each species, index is the id
+	std::unordered_map<uint64_t, SpeciesId> ids;
+	std::vector<force_t> pairs; //capacity x capacity, row is the measuring species
+	std::vector<uint8_t> bonds; //PairBond of each entry in pairs
+	size_t capacity;
+
+	static uint64_t keyOf(const Atom& atom);
+
+	/* Pressure the way Atom::setForceFor used to measure it, 0 and PB_NONE unless both atoms exist
+	*/
+	static double measure(const Atom& a, const Atom& b, PairBond& bond);
+
+	void grow();
+
+public:
+	SpeciesTable();
+
+	/* Id of the atom's species, registering it if it was never seen before
+	*/
+	SpeciesId idOf(const Atom& atom);
+
+	size_t count() const;
+
+	/* Composition shared by every atom of a species
+	*/
+	const Atom& atomOf(SpeciesId id) const;
+
+	/* Force species a applies against species b
+	* positive pushes the two apart, negative pulls them together
+	*/
+	force_t pairPressure(SpeciesId a, SpeciesId b) const;
+
+	/* How species a and b bond, the same either way round
+	*/
+	PairBond pairBond(SpeciesId a, SpeciesId b) const;
+};
+
+inline force_t SpeciesTable::pairPressure(SpeciesId a, SpeciesId b) const {
+	return this->pairs[a * this->capacity + b];
+}
+
+inline PairBond SpeciesTable::pairBond(SpeciesId a, SpeciesId b) const {
+	return (PairBond)this->bonds[a * this->capacity + b];
+}
+
+inline const Atom& SpeciesTable::atomOf(SpeciesId id) const {
+	return this->species[id];
+}
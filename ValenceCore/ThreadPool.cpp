@@ -0,0 +1,87 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads) {
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	if (threads <= 0) {
+		threads = 1;
+	}
+	this->task = nullptr;
+	this->taskCount = 0;
+	this->nextTask = 0;
+	this->busyWorkers = 0;
+	this->generation = 0;
+	this->stopping = false;
+	//the calling thread always takes part in run() so it counts as one of the threads
+	for (int i = 1; i < threads; i++) {
+		this->workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread& worker : this->workers) {
+		worker.join();
+	}
+}
+
+int ThreadPool::threadCount() const {
+	return (int)this->workers.size() + 1;
+}
+
+void ThreadPool::drain() {
+	int i;
+	while ((i = this->nextTask.fetch_add(1)) < this->taskCount) {
+		(*this->task)(i);
+	}
+}
+
+void ThreadPool::workerLoop() {
+	unsigned long seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->wake.wait(lock, [&] { return this->stopping || this->generation != seen; });
+			if (this->stopping) {
+				return;
+			}
+			seen = this->generation;
+		}
+		this->drain();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->busyWorkers--;
+		}
+		this->finished.notify_one();
+	}
+}
+
+void ThreadPool::run(int count, const std::function<void(int)>& task) {
+	if (count <= 0) {
+		return;
+	}
+	if (this->workers.empty() || count == 1) {
+		for (int i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->task = &task;
+		this->taskCount = count;
+		this->nextTask = 0;
+		this->busyWorkers = (int)this->workers.size();
+		this->generation++;
+	}
+	this->wake.notify_all();
+	this->drain();
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->finished.wait(lock, [&] { return this->busyWorkers == 0; });
+	this->task = nullptr;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+
+/*
+* Fixed set of worker threads used by the universe's parallel update
+*
+* run() hands out task indices 0..count-1 to the workers and the calling thread,
+* and only returns once every task has finished. Calling run() once per phase
+* therefore acts as the barrier between phases.
+*/
+class ThreadPool {
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+
+	const std::function<void(int)>* task;
+	int taskCount;
+	std::atomic<int> nextTask;
+	int busyWorkers;
+	unsigned long generation;
+	bool stopping;
+
+	void workerLoop();
+
+	//pull task indices until there are none left
+	void drain();
+
+public:
+	/* @param threads total threads working on a run, including the caller.
+	* 0 uses every hardware thread
+	*/
+	ThreadPool(int threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int threadCount() const;
+
+	/* Runs task(i) for every i in [0, count) across the pool, blocking until all are done
+	*/
+	void run(int count, const std::function<void(int)>& task);
+};
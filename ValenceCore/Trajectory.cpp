@@ -0,0 +1,493 @@
+#include "Trajectory.h"
+#include <algorithm>
+#include <cstring>
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+//reads a payload back, a read past its end sets failed and returns 0
+struct PayloadReader {
+	const uint8_t* next;
+	const uint8_t* end;
+	bool failed;
+
+	uint64_t varint() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (this->next == this->end) {
+				break;
+			}
+			uint8_t byte = *this->next++;
+			value |= (uint64_t)(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		this->failed = true;
+		return 0;
+	}
+
+	uint8_t byte() {
+		if (this->next == this->end) {
+			this->failed = true;
+			return 0;
+		}
+		return *this->next++;
+	}
+};
+
+static void putComposition(std::vector<uint8_t>& out, const Atom& atom) {
+	putVarint(out, (uint64_t)atom.getProtons());
+	putVarint(out, (uint64_t)atom.getNeutrons());
+	putVarint(out, (uint64_t)atom.getElectrons());
+}
+
+static Atom readComposition(PayloadReader& in) {
+	int protons = (int)in.varint();
+	int neutrons = (int)in.varint();
+	int electrons = (int)in.varint();
+	return Atom(protons, neutrons, electrons);
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path, Universe& universe, int keyframeInterval) : out(path, std::ios::binary | std::ios::trunc) {
+	this->frameWidth = universe.width();
+	this->frameHeight = universe.height();
+	this->keyframeInterval = (uint32_t)std::max(keyframeInterval, 1);
+	this->started = false;
+	this->lastStep = 0;
+	this->knownSpecies = 0;
+	this->closing = false;
+	this->keyframeBase = 0;
+	this->failed = false;
+	if (!this->out) {
+		std::cerr << "Could not create trajectory " << path << std::endl;
+		return;
+	}
+	TrajectoryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+	header.version = TRAJECTORY_VERSION;
+	header.keyframeInterval = this->keyframeInterval;
+	header.width = this->frameWidth;
+	header.height = this->frameHeight;
+	header.seed = universe.getSeed();
+	header.boundary = universe.getBoundary();
+	this->out.write((const char*)&header, sizeof(header));
+	this->writer = std::thread(&TrajectoryWriter::writeLoop, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+	this->close();
+	for (PendingStep* pending : this->spare) {
+		delete pending;
+	}
+}
+
+bool TrajectoryWriter::isOpen() {
+	return this->writer.joinable();
+}
+
+void TrajectoryWriter::record(Universe& universe) {
+	if (!this->isOpen()) {
+		return;
+	}
+	PendingStep* pending = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (!this->spare.empty()) {
+			pending = this->spare.back();
+			this->spare.pop_back();
+		}
+	}
+	if (pending == nullptr) {
+		pending = new PendingStep();
+	}
+	pending->step = universe.getStep();
+	pending->full = !this->started || pending->step != this->lastStep + 1;
+	if (pending->full) {
+		RenderSnapshot frame;
+		universe.writeSnapshot(frame);
+		pending->cells.resize(frame.cells.size());
+		for (size_t i = 0; i < frame.cells.size(); i++) {
+			pending->cells[i].cell = i;
+			pending->cells[i].species = frame.cells[i].species;
+			pending->cells[i].valence = frame.cells[i].valence;
+		}
+	}
+	else {
+		universe.changedCells(pending->cells);
+	}
+	const SpeciesTable& table = universe.getSpeciesTable();
+	pending->newSpecies.clear();
+	for (size_t id = this->knownSpecies; id < table.count(); id++) {
+		pending->newSpecies.push_back(table.atomOf((SpeciesId)id));
+	}
+	this->knownSpecies = table.count();
+	this->started = true;
+	this->lastStep = pending->step;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->queue.push_back(pending);
+	}
+	this->wake.notify_one();
+}
+
+bool TrajectoryWriter::close() {
+	if (this->isOpen()) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->closing = true;
+		}
+		this->wake.notify_one();
+		this->writer.join();
+		this->out.close();
+		if (!this->out && !this->failed) {
+			std::cerr << "Could not finish writing the trajectory" << std::endl;
+			this->failed = true;
+		}
+	}
+	return !this->failed;
+}
+
+void TrajectoryWriter::writeLoop() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->wake.wait(lock, [this] { return this->closing || !this->queue.empty(); });
+		if (this->queue.empty()) {
+			return; //closing and every step is written
+		}
+		PendingStep* pending = this->queue.front();
+		this->queue.pop_front();
+		lock.unlock();
+		this->writeStep(*pending);
+		lock.lock();
+		this->spare.push_back(pending);
+	}
+}
+
+void TrajectoryWriter::writeStep(PendingStep& pending) {
+	this->compositions.insert(this->compositions.end(), pending.newSpecies.begin(), pending.newSpecies.end());
+	if (pending.full) {
+		this->species.assign((size_t)this->frameWidth * this->frameHeight, EMPTY_SPECIES);
+		this->valence.assign(this->species.size(), 0);
+		this->keyframeBase = pending.step;
+	}
+	//cells whose stamp came around again still hold what the frame has, only real changes are kept
+	this->changes.clear();
+	for (const CellChange& change : pending.cells) {
+		if (this->species[change.cell] != change.species || this->valence[change.cell] != change.valence) {
+			this->species[change.cell] = change.species;
+			this->valence[change.cell] = change.valence;
+			this->changes.push_back(change);
+		}
+	}
+	if (pending.full || (pending.step - this->keyframeBase) % this->keyframeInterval == 0) {
+		this->encodeKeyframe();
+		this->writeRecord(TR_KEYFRAME, pending.step);
+	}
+	else {
+		this->encodeDelta(pending);
+		this->writeRecord(TR_DELTA, pending.step);
+	}
+}
+
+void TrajectoryWriter::encodeKeyframe() {
+	this->payload.clear();
+	putVarint(this->payload, this->compositions.size());
+	for (const Atom& composition : this->compositions) {
+		putComposition(this->payload, composition);
+	}
+	//runs of identical cells, long stretches of empty space become a few bytes
+	const size_t cells = this->species.size();
+	size_t i = 0;
+	while (i < cells) {
+		size_t end = i + 1;
+		while (end < cells && this->species[end] == this->species[i] && this->valence[end] == this->valence[i]) {
+			end++;
+		}
+		putVarint(this->payload, end - i);
+		putVarint(this->payload, this->species[i]);
+		this->payload.push_back(this->valence[i]);
+		i = end;
+	}
+}
+
+void TrajectoryWriter::encodeDelta(const PendingStep& pending) {
+	this->payload.clear();
+	putVarint(this->payload, pending.newSpecies.size());
+	for (const Atom& composition : pending.newSpecies) {
+		putComposition(this->payload, composition);
+	}
+	//runs of changed neighbors, each after the number of cells skipped since the run before
+	putVarint(this->payload, this->changes.size());
+	uint64_t previousEnd = 0;
+	size_t i = 0;
+	while (i < this->changes.size()) {
+		size_t end = i + 1;
+		while (end < this->changes.size() && this->changes[end].cell == this->changes[end - 1].cell + 1) {
+			end++;
+		}
+		putVarint(this->payload, this->changes[i].cell - previousEnd);
+		putVarint(this->payload, end - i);
+		for (size_t c = i; c < end; c++) {
+			putVarint(this->payload, this->changes[c].species);
+			this->payload.push_back(this->changes[c].valence);
+		}
+		previousEnd = this->changes[end - 1].cell + 1;
+		i = end;
+	}
+}
+
+void TrajectoryWriter::writeRecord(TrajectoryRecordType type, uint64_t step) {
+	if (this->failed) {
+		return; //the records after a missing one would not decode, the file ends at the last good one
+	}
+	if (this->payload.size() > 0xFFFFFFFFu) {
+		std::cerr << "Could not write the trajectory at step " << step << ", its frame needs more than 4 GiB" << std::endl;
+		this->failed = true;
+		return;
+	}
+	TrajectoryRecord record;
+	record.type = type;
+	record.bytes = (uint32_t)this->payload.size();
+	record.step = step;
+	this->out.write((const char*)&record, sizeof(record));
+	this->out.write((const char*)this->payload.data(), this->payload.size());
+	if (!this->out && !this->failed) {
+		std::cerr << "Could not write the trajectory at step " << step << std::endl;
+		this->failed = true;
+	}
+}
+
+TrajectoryReader::TrajectoryReader(const std::string& path) {
+	this->nextRecord = 0;
+	this->currentStep = 0;
+	this->hasFrame = false;
+	memset(&this->header, 0, sizeof(this->header));
+	this->file = new MappedFile(path);
+	const char* problem = nullptr;
+	if (!this->file->isOpen()) {
+		problem = "cannot be read";
+	}
+	else if (this->file->size() < sizeof(TrajectoryHeader)) {
+		problem = "not a trajectory";
+	}
+	else {
+		memcpy(&this->header, this->file->data(), sizeof(TrajectoryHeader));
+		if (memcmp(this->header.magic, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) != 0) {
+			problem = "not a trajectory";
+		}
+		else if (this->header.version != TRAJECTORY_VERSION) {
+			problem = "recorded by a different version";
+		}
+		else if (this->header.width < 1 || this->header.height < 1) {
+			problem = "damaged header";
+		}
+	}
+	if (problem == nullptr) {
+		//a recording cut short by a crash still plays up to its last complete record
+		size_t offset = sizeof(TrajectoryHeader);
+		while (offset + sizeof(TrajectoryRecord) <= this->file->size()) {
+			TrajectoryRecord record;
+			memcpy(&record, this->file->data() + offset, sizeof(record));
+			offset += sizeof(record);
+			if ((record.type != TR_KEYFRAME && record.type != TR_DELTA) || record.bytes > this->file->size() - offset) {
+				break;
+			}
+			IndexEntry entry;
+			entry.step = record.step;
+			entry.offset = offset;
+			entry.bytes = record.bytes;
+			entry.type = record.type;
+			this->records.push_back(entry);
+			offset += record.bytes;
+		}
+		if (this->records.empty() || this->records[0].type != TR_KEYFRAME) {
+			problem = "holds no frames";
+		}
+	}
+	if (problem != nullptr) {
+		std::cerr << "Could not open trajectory " << path << ": " << problem << std::endl;
+		delete this->file;
+		this->file = nullptr;
+		return;
+	}
+	this->seek(this->firstStep());
+}
+
+TrajectoryReader::~TrajectoryReader() {
+	delete this->file;
+}
+
+bool TrajectoryReader::isOpen() {
+	return this->file != nullptr;
+}
+
+int TrajectoryReader::width() {
+	return this->header.width;
+}
+
+int TrajectoryReader::height() {
+	return this->header.height;
+}
+
+uint64_t TrajectoryReader::getSeed() {
+	return this->header.seed;
+}
+
+BoundaryMode TrajectoryReader::getBoundary() {
+	return (BoundaryMode)this->header.boundary;
+}
+
+uint64_t TrajectoryReader::firstStep() {
+	return this->records.empty() ? 0 : this->records.front().step;
+}
+
+uint64_t TrajectoryReader::lastStep() {
+	return this->records.empty() ? 0 : this->records.back().step;
+}
+
+uint64_t TrajectoryReader::getStep() {
+	return this->currentStep;
+}
+
+bool TrajectoryReader::seek(uint64_t step) {
+	if (!this->isOpen() || step < this->firstStep() || step > this->lastStep()) {
+		return false;
+	}
+	//steps only grow along the file, the frame is rebuilt from the last keyframe at or before step
+	auto after = std::upper_bound(this->records.begin(), this->records.end(), step,
+		[](uint64_t s, const IndexEntry& record) { return s < record.step; });
+	size_t keyframe = (size_t)(after - this->records.begin()) - 1;
+	while (this->records[keyframe].type != TR_KEYFRAME) {
+		keyframe--;
+	}
+	//playing on from the frame held is cheaper when no keyframe lies between it and step
+	bool playOn = this->hasFrame && this->currentStep <= step && this->nextRecord > keyframe;
+	if (!playOn) {
+		this->hasFrame = false;
+		this->nextRecord = keyframe;
+	}
+	while (this->nextRecord < this->records.size() && this->records[this->nextRecord].step <= step) {
+		if (!this->apply(this->records[this->nextRecord])) {
+			return false;
+		}
+		this->nextRecord++;
+	}
+	return this->currentStep == step;
+}
+
+bool TrajectoryReader::step() {
+	if (!this->isOpen() || this->nextRecord >= this->records.size()) {
+		return false;
+	}
+	if (!this->apply(this->records[this->nextRecord])) {
+		return false;
+	}
+	this->nextRecord++;
+	return true;
+}
+
+bool TrajectoryReader::apply(const IndexEntry& record) {
+	PayloadReader in;
+	in.next = this->file->data() + record.offset;
+	in.end = in.next + record.bytes;
+	in.failed = false;
+	const size_t cells = (size_t)this->header.width * this->header.height;
+	if (record.type == TR_KEYFRAME) {
+		uint64_t count = in.varint();
+		this->compositions.clear();
+		for (uint64_t id = 0; id < count && !in.failed; id++) {
+			this->compositions.push_back(readComposition(in));
+		}
+		this->species.resize(cells);
+		this->valence.resize(cells);
+		size_t cell = 0;
+		while (cell < cells && !in.failed) {
+			uint64_t length = in.varint();
+			uint64_t id = in.varint();
+			uint8_t shell = in.byte();
+			if (length == 0 || length > cells - cell || id >= this->compositions.size()) {
+				in.failed = true;
+				break;
+			}
+			std::fill_n(this->species.begin() + cell, length, (SpeciesId)id);
+			std::fill_n(this->valence.begin() + cell, length, shell);
+			cell += (size_t)length;
+		}
+	}
+	else {
+		if (!this->hasFrame) {
+			in.failed = true;
+		}
+		uint64_t count = in.failed ? 0 : in.varint();
+		for (uint64_t s = 0; s < count && !in.failed; s++) {
+			this->compositions.push_back(readComposition(in));
+		}
+		uint64_t changed = in.failed ? 0 : in.varint();
+		uint64_t cell = 0;
+		while (changed > 0 && !in.failed) {
+			cell += in.varint();
+			uint64_t length = in.varint();
+			if (length == 0 || length > changed || cell > cells || length > cells - cell) {
+				in.failed = true;
+				break;
+			}
+			for (uint64_t c = 0; c < length && !in.failed; c++, cell++) {
+				uint64_t id = in.varint();
+				if (id >= this->compositions.size()) {
+					in.failed = true;
+				}
+				this->species[cell] = (SpeciesId)id;
+				this->valence[cell] = in.byte();
+			}
+			changed -= length;
+		}
+	}
+	if (in.failed) {
+		std::cerr << "Trajectory is damaged at step " << record.step << std::endl;
+		this->hasFrame = false;
+		return false;
+	}
+	this->currentStep = record.step;
+	this->hasFrame = true;
+	return true;
+}
+
+void TrajectoryReader::writeSnapshot(RenderSnapshot& out) {
+	if (!this->hasFrame) {
+		out.width = out.height = 0;
+		out.cells.clear();
+		return;
+	}
+	out.width = this->header.width;
+	out.height = this->header.height;
+	out.step = this->currentStep;
+	out.cells.resize(this->species.size());
+	for (size_t i = 0; i < this->species.size(); i++) {
+		const Atom& atom = this->compositions[this->species[i]];
+		out.cells[i].protons = (uint16_t)atom.getProtons();
+		out.cells[i].neutrons = (uint16_t)atom.getNeutrons();
+		out.cells[i].species = this->species[i];
+		out.cells[i].valence = this->valence[i];
+	}
+}
+
+void TrajectoryReader::writeState(std::ostream& out) {
+	out << this->header.width << " " << this->header.height << std::endl;
+	for (int y = 0; y < this->header.height && this->hasFrame; y++) {
+		for (int x = 0; x < this->header.width; x++) {
+			const Atom& atom = this->compositions[this->species[(size_t)y * this->header.width + x]];
+			if (x) {
+				out << " ";
+			}
+			out << atom.getProtons() << "," << atom.getNeutrons() << "," << atom.getElectrons();
+		}
+		out << std::endl;
+	}
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "Universe.h"
+#include "MappedFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* Recorded run of a universe, one frame per update
+*
+* A trajectory file is a TrajectoryHeader followed by records, each a TrajectoryRecord and its payload.
+* A keyframe holds the species table and every cell as runs of identical cells. A delta holds only the cells
+* that changed during its update, as runs of neighboring cells separated by the number of cells left alone.
+* A keyframe replaces the delta every keyframeInterval steps and after any step that was not recorded,
+* so seeking decodes one keyframe and fewer than keyframeInterval deltas.
+*
+* Frames hold the species and valence shell of every cell, enough to draw or analyze a run but not to
+* carry it on, a checkpoint does that. Counts and cells inside a payload are LEB128 varints.
+*
+* Bump TRAJECTORY_VERSION whenever the header, the records or a payload change.
+*/
+
+const char TRAJECTORY_MAGIC[8] = { 'V', 'A', 'L', 'T', 'R', 'A', 'J', '\0' };
+const uint32_t TRAJECTORY_VERSION = 1;
+
+typedef enum TrajectoryRecordType { TR_KEYFRAME = 1, TR_DELTA = 2 } TrajectoryRecordType;
+
+struct TrajectoryHeader {
+	char magic[8];             //TRAJECTORY_MAGIC
+	uint32_t version;          //TRAJECTORY_VERSION of the build that recorded it
+	uint32_t keyframeInterval; //steps between keyframes
+	int32_t width;
+	int32_t height;
+	uint64_t seed;
+	uint32_t boundary;         //BoundaryMode
+	uint32_t reserved;
+};
+
+static_assert(sizeof(TrajectoryHeader) == 40, "the trajectory header must not pick up padding");
+
+struct TrajectoryRecord {
+	uint32_t type;  //TrajectoryRecordType
+	uint32_t bytes; //payload following the record
+	uint64_t step;  //updates the universe had completed in this frame
+};
+
+/*
+* Records a universe while it runs
+*
+* record() is called on the update thread once before the first update and after every update,
+* it only collects the cells that changed and hands them to a background thread that compresses
+* and writes them, so the update loop never waits for the disk. Steps queue up in memory while
+* the disk falls behind and are all written before close() returns.
+*/
+class TrajectoryWriter {
+	//one recorded step on its way to the writing thread
+	struct PendingStep {
+		uint64_t step;
+		bool full; //cells holds every cell instead of the changed ones
+		std::vector<CellChange> cells;
+		std::vector<Atom> newSpecies; //registered since the step before
+	};
+
+	std::ofstream out;
+	int frameWidth;
+	int frameHeight;
+	uint32_t keyframeInterval;
+
+	//owned by the update thread
+	bool started;
+	uint64_t lastStep;
+	size_t knownSpecies;
+
+	//shared with the writing thread
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<PendingStep*> queue;
+	std::vector<PendingStep*> spare; //written steps kept for their memory
+	bool closing;
+	std::thread writer; //only runs while the file is open
+
+	//owned by the writing thread, the frame as the file last described it
+	uint64_t keyframeBase; //step keyframes are counted from
+	std::vector<Atom> compositions;
+	std::vector<SpeciesId> species;
+	std::vector<uint8_t> valence;
+	std::vector<uint8_t> payload;
+	std::vector<CellChange> changes;
+	bool failed;
+
+	void writeLoop();
+	void writeStep(PendingStep& pending);
+	void encodeKeyframe();
+	void encodeDelta(const PendingStep& pending);
+	void writeRecord(TrajectoryRecordType type, uint64_t step);
+
+public:
+	/* Starts a trajectory of universe at path, isOpen tells whether the file could be created
+	* @param keyframeInterval steps between keyframes, more makes a smaller file and slower seeks
+	*/
+	TrajectoryWriter(const std::string& path, Universe& universe, int keyframeInterval);
+	~TrajectoryWriter();
+
+	TrajectoryWriter(const TrajectoryWriter&) = delete;
+	TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+	bool isOpen();
+
+	/* Adds the universe as it is now, a keyframe when the step before it was not recorded
+	*/
+	void record(Universe& universe);
+
+	/* Writes every step still queued and closes the file, called by the destructor as well
+	* @return false when part of the trajectory could not be written
+	*/
+	bool close();
+};
+
+/*
+* Plays a recorded trajectory back
+*
+* The file is mapped and indexed on opening by skipping from record to record, frames are only
+* decoded while seeking or stepping. A reader holds one frame, the step it is at.
+*/
+class TrajectoryReader {
+	struct IndexEntry {
+		uint64_t step;
+		size_t offset; //payload start in the file
+		uint32_t bytes;
+		uint32_t type;
+	};
+
+	MappedFile* file; //nullptr when the trajectory could not be opened
+	TrajectoryHeader header;
+	std::vector<IndexEntry> records; //complete records in file order, a cut off one at the end is left out
+	size_t nextRecord;               //record step() applies
+	uint64_t currentStep;
+	bool hasFrame;
+
+	std::vector<Atom> compositions;
+	std::vector<SpeciesId> species;
+	std::vector<uint8_t> valence;
+
+	bool apply(const IndexEntry& record);
+
+public:
+	/* Opens the trajectory at path, isOpen tells whether it was one this build can play
+	*/
+	TrajectoryReader(const std::string& path);
+	~TrajectoryReader();
+
+	TrajectoryReader(const TrajectoryReader&) = delete;
+	TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+	bool isOpen();
+	int width();
+	int height();
+	uint64_t getSeed();
+	BoundaryMode getBoundary();
+
+	/* First and last step recorded
+	*/
+	uint64_t firstStep();
+	uint64_t lastStep();
+
+	/* Step of the frame the reader holds
+	*/
+	uint64_t getStep();
+
+	/* Moves to the frame of step, false when it was not recorded or the file is damaged there
+	*/
+	bool seek(uint64_t step);
+
+	/* Moves to the next recorded frame, false at the end of the trajectory
+	*/
+	bool step();
+
+	/* Same as Universe::writeSnapshot for the frame the reader holds, an empty snapshot after a damaged record
+	*/
+	void writeSnapshot(RenderSnapshot& out);
+
+	/* Same text as Universe::writeState for the frame the reader holds
+	*/
+	void writeState(std::ostream& out);
+};
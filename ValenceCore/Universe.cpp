@@ -0,0 +1,1057 @@
+#include "Universe.h"
+#include "Config.h"
+#include "Checkpoint.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+Universe::Universe() {
+	universeWidth = universeHeight = 0;
+	this->boundary = BM_TORUS;
+	this->seed = 0;
+	this->stepCount = 0;
+	space = nullptr;
+	this->engine = UE_SERIAL;
+	this->pool = nullptr;
+	this->tileColumns = 0;
+	this->edges = nullptr;
+	this->claims = nullptr;
+	this->kernels = &forceKernels();
+	this->incremental = true;
+	this->recomputeAll = true;
+}
+
+Universe::Universe(int size, uint64_t seed, BoundaryMode boundary) : Universe(size, size, seed, boundary) {
+}
+
+Universe::Universe(int width, int height, uint64_t seed, BoundaryMode boundary, int cellsPerAtom) {
+	this->universeWidth = width;
+	this->universeHeight = height;
+	this->boundary = boundary;
+	this->seed = seed;
+	this->stepCount = 0;
+	this->engine = UE_SERIAL;
+	this->pool = nullptr;
+	this->tileColumns = 0;
+	this->kernels = &forceKernels();
+	this->space = new AtomGrid(width, height, &this->speciesTable);
+	this->createLayout(cellsPerAtom);
+	this->prepareSpace();
+}
+
+void Universe::prepareSpace() {
+	const int width = this->universeWidth;
+	const int height = this->universeHeight;
+	this->edges = new ForceEdges(this->space->cells());
+	this->claims = new std::atomic<uint64_t>[this->space->cells()]();
+	this->isolated.resize(this->space->cells());
+	this->netForce.resize(this->space->cells());
+	this->incremental = true;
+	this->recomputeAll = true;
+	this->movedAt.resize(this->space->cells());
+	this->edgesChangedAt.resize(this->space->cells());
+	this->lanesChangedAt.resize(this->space->cells());
+	for (int d = 0; d < 8; d++) {
+		this->offset[d] = this->space->neighborOffset((OFP)d);
+	}
+	this->ghostRows.push_back(0);
+	for (int y = -1; y <= height; y++) {
+		for (int x = -1; x <= width; x++) {
+			if (this->inside(y, x)) {
+				continue;
+			}
+			Ghost ghost;
+			ghost.y = y;
+			ghost.x = x;
+			ghost.cell = this->space->index(y, x);
+			if (this->boundary == BM_TORUS) {
+				ghost.source = this->space->index(this->wrapY(y), this->wrapX(x));
+			}
+			else if (this->boundary == BM_REFLECT) {
+				ghost.source = this->space->index(std::min(std::max(y, 0), height - 1), std::min(std::max(x, 0), width - 1));
+			}
+			else {
+				ghost.source = NO_CELL;
+			}
+			this->ghosts.push_back(ghost);
+		}
+		this->ghostRows.push_back(this->ghosts.size());
+	}
+	this->refreshGhosts(this->space->species, true);
+}
+
+Universe::~Universe() {
+	delete this->pool;
+	delete this->space;
+	delete this->edges;
+	delete[] this->claims;
+}
+
+void Universe::createLayout(int cellsPerAtom) {
+	//the species table is not thread safe, so every composition a layout can hold is registered first
+	SpeciesId ids[9];
+	for (int pne = 0; pne < 9; pne++) {
+		ids[pne] = pne ? this->speciesTable.idOf(Atom(pne, pne, pne)) : EMPTY_SPECIES;
+	}
+	//threads only pay off once there is a tile worth of rows, debug output has to stay in order
+	ThreadPool rows(this->universeHeight >= TILE_SIZE && !DEBUG ? 0 : 1);
+	rows.run(this->universeHeight, [this, &ids, cellsPerAtom](int y) {
+		for (int x = 0; x < this->universeWidth; x++) {
+			CounterRandom random(this->seed, (uint64_t)y * this->universeWidth + x, 0);
+			int pne = 0;
+			if (random.nextInt(cellsPerAtom) == 0) {
+				pne = random.nextInt(9);
+			}
+			Atom atom(pne, pne, pne, random.nextInt(8));
+			size_t i = this->space->index(y, x);
+			this->space->setAtom(i, atom, ids[pne]);
+		}
+	});
+}
+
+int Universe::wrapY(int y) {
+	if (y < 0) {
+		return y + this->universeHeight;
+	}
+	else if (y >= this->universeHeight) {
+		return y - this->universeHeight;
+	}
+	return y;
+}
+
+int Universe::wrapX(int x) {
+	if (x < 0) {
+		return x + this->universeWidth;
+	}
+	else if (x >= this->universeWidth) {
+		return x - this->universeWidth;
+	}
+	return x;
+}
+
+bool Universe::inside(int y, int x) {
+	return y >= 0 && y < this->universeHeight && x >= 0 && x < this->universeWidth;
+}
+
+size_t Universe::orderOf(int y, int x) {
+	if (this->boundary == BM_TORUS) {
+		return this->space->index(this->wrapY(y), this->wrapX(x));
+	}
+	return this->space->index(y, x);
+}
+
+void Universe::getNeighborsFor(int y, int x, size_t neighbors[8]) {
+	size_t self = this->space->index(y, x);
+	for (int d = 0; d < 8; d++) {
+		neighbors[d] = self + this->offset[d];
+	}
+}
+
+template <typename T>
+void Universe::refreshGhosts(T* cells, bool mirror) {
+	const bool copy = mirror || this->boundary == BM_TORUS;
+	for (const Ghost& ghost : this->ghosts) {
+		if (copy && ghost.source != NO_CELL) {
+			cells[ghost.cell] = cells[ghost.source];
+		}
+		else {
+			cells[ghost.cell] = T();
+		}
+	}
+}
+
+void Universe::refreshEdgeGhosts(int y0, int y1) {
+	const Ghost* first = this->ghosts.data() + this->ghostRows[y0 + 1];
+	const Ghost* last = this->ghosts.data() + this->ghostRows[y1 + 1];
+	if (this->boundary == BM_TORUS) {
+		for (const Ghost* ghost = first; ghost < last; ghost++) {
+			for (int e = 0; e < 4; e++) {
+				this->edges->edge[e][ghost->cell] = this->edges->edge[e][ghost->source];
+			}
+		}
+		return;
+	}
+	//beyond a wall the pair between a ghost and a cell inside belongs to the cell inside,
+	//pairs between two ghosts apply no force
+	for (const Ghost* ghost = first; ghost < last; ghost++) {
+		for (int e = 0; e < 4; e++) {
+			OFP position = edgePosition(e);
+			int y = ghost->y + OFP_Y[position];
+			int x = ghost->x + OFP_X[position];
+			force_t force = 0;
+			if (this->inside(y, x)) {
+				force = this->measurePair(this->space->index(y, x), ghost->cell, (OFP)((position + 4) % 8));
+			}
+			this->edges->edge[e][ghost->cell] = force;
+		}
+	}
+}
+
+bool Universe::hasNoNeighbors(int y, int x) {
+	size_t neighbors[8];
+	this->getNeighborsFor(y, x, neighbors);
+	for (int i = 0; i < 8; i++) {
+		if (!this->space->isEmpty(neighbors[i])) {
+			return false; //we have a neighbor
+		}
+	}
+	return true; //we have no neighbors
+}
+
+uint8_t Universe::stepStamp(int stepsAgo) {
+	return (uint8_t)(this->stepCount - stepsAgo);
+}
+
+bool Universe::movedNear(size_t self) {
+	const uint8_t last = this->stepStamp(1);
+	if (this->movedAt[self] == last) {
+		return true;
+	}
+	for (int d = 0; d < 8; d++) {
+		if (this->movedAt[self + this->offset[d]] == last) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Universe::measureDirty(size_t self) {
+	if (this->recomputeAll || this->movedNear(self)) {
+		return true;
+	}
+	//an isolated atom's pairs are its own lanes, which the last sync may have changed
+	return this->isolated[self] && this->lanesChangedAt[self] == this->stepStamp(1);
+}
+
+bool Universe::syncDirty(size_t self) {
+	if (this->recomputeAll || this->movedAt[self] == this->stepStamp(1)) {
+		return true; //an atom brought its lanes along, they no longer match the pairs around the cell
+	}
+	//the kernels read the pairs stored by the cell, its left and right neighbors and the three cells above
+	const uint8_t now = this->stepStamp();
+	const size_t above = self - this->space->stride();
+	return this->edgesChangedAt[self - 1] == now || this->edgesChangedAt[self] == now || this->edgesChangedAt[self + 1] == now
+		|| this->edgesChangedAt[above - 1] == now || this->edgesChangedAt[above] == now || this->edgesChangedAt[above + 1] == now;
+}
+
+bool Universe::stampEdges(size_t self, const force_t before[4]) {
+	//compared bit for bit so a pair that flips the sign of a zero still counts as changed
+	for (int e = 0; e < 4; e++) {
+		if (memcmp(&before[e], &this->edges->edge[e][self], sizeof(force_t)) != 0) {
+			this->edgesChangedAt[self] = this->stepStamp();
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t Universe::moveTarget(int y, int x, OFP& direction) {
+	//check which direction the force is telling the atom to move in
+	const NetForce& net = this->netForce[this->space->index(y, x)];
+	direction = getOFP(0, 0, net.dx, net.dy);
+	if (direction == F_NONE) {
+		return NO_CELL;
+	}
+	int checkX = x + net.dx;
+	int checkY = y + net.dy;
+	if (!this->inside(checkY, checkX)) {
+		if (this->boundary != BM_TORUS) {
+			return NO_CELL; //nothing can leave the universe
+		}
+		checkX = this->wrapX(checkX);
+		checkY = this->wrapY(checkY);
+	}
+	return this->space->index(checkY, checkX);
+}
+
+uint64_t Universe::claimPriority(size_t self, OFP direction) {
+	force_t force = forceTowards(this->netForce[self], direction);
+	uint64_t bits;
+	if (sizeof(force_t) == sizeof(uint32_t)) {
+		uint32_t narrow;
+		memcpy(&narrow, &force, sizeof(narrow));
+		bits = (uint64_t)narrow << 32;
+	}
+	else {
+		memcpy(&bits, &force, sizeof(bits));
+	}
+	//the force is positive so its bits sort like the force itself, the lowest 4 bits are
+	//replaced by where the atom comes from, on a tie the atom reached first around the target wins
+	OFP from = (OFP)((direction + 4) % 8);
+	return (bits & ~(uint64_t)15) | (uint64_t)(8 - from);
+}
+
+void Universe::claimMove(int y, int x) {
+	size_t self = this->space->index(y, x);
+	if (this->space->isEmpty(self)) {
+		return;
+	}
+	OFP direction;
+	size_t target = this->moveTarget(y, x, direction);
+	if (target == NO_CELL) {
+		return;
+	}
+	//if there is an atom here we cannot move into that position
+	if (!this->space->isEmpty(target)) {
+		if (DEBUG && PRINT_MOVEMENT_CALCULATION) {
+			std::cout << "(" << x << ", " << y << ") BLOCKED" << std::endl;
+		}
+		return;
+	}
+	//atomic max, every order of claims leaves the same winner
+	uint64_t priority = this->claimPriority(self, direction);
+	std::atomic<uint64_t>& claim = this->claims[target];
+	uint64_t current = claim.load(std::memory_order_relaxed);
+	while (priority > current && !claim.compare_exchange_weak(current, priority, std::memory_order_relaxed)) {
+	}
+}
+
+MoveOutcome Universe::moveAtoms(int y, int x) {
+	//cells change while atoms move, so only the net forces and claims are read here
+	OFP direction;
+	size_t target = this->moveTarget(y, x, direction);
+	if (target == NO_CELL) {
+		return direction == F_NONE ? MO_STAYED : MO_BLOCKED;
+	}
+	size_t self = this->space->index(y, x);
+	//the priority names the cell it came from, only the atom that won the claim finds its own,
+	//nobody claims a cell that held an atom
+	uint64_t claim = this->claims[target].load(std::memory_order_relaxed);
+	bool won = claim == this->claimPriority(self, direction);
+	if (DEBUG && PRINT_MOVEMENT_CALCULATION) {
+		std::cout << "Move atoms calculated for: (" << x << ", " << y << ")";
+		std::cout << " dx:" << (int)this->netForce[self].dx << "  dy:" << (int)this->netForce[self].dy;
+		std::cout << (won ? " PASS" : " FAIL") << std::endl;
+	}
+	if (won) {
+		this->space->swapCells(self, target);
+		this->movedAt[self] = this->stepStamp();
+		this->movedAt[target] = this->stepStamp();
+		return MO_MOVED;
+	}
+	return claim == 0 ? MO_BLOCKED : MO_OUTBID;
+}
+
+void Universe::update() {
+	if (DEBUG && WAIT_ON_UPDATE) {
+		std::cout << std::endl << "Update started" << std::endl;
+	}
+	PhaseClock clock(PT_UPDATE);
+	if (!this->incremental) {
+		this->recomputeAll = true;
+	}
+	if (this->engine == UE_TILED) {
+		this->updateTiled();
+	}
+	else if (this->engine == UE_FUSED && this->universeHeight >= 4) {
+		this->updateFused();
+	}
+	else {
+		this->updateSerial();
+	}
+	if (DEBUG && WAIT_ON_UPDATE) {
+		std::cout << std::endl << "Update completed" << std::endl;
+		std::cin.get();
+	}
+	this->refreshGhosts(this->space->species, true);
+	this->recomputeAll = !this->incremental;
+	this->stepCount++;
+}
+
+void Universe::updateSerial() {
+	Tile all;
+	all.x0 = all.y0 = 0;
+	all.x1 = universeWidth;
+	all.y1 = universeHeight;
+	{
+		PhaseClock clock(PT_PRESSURE);
+		this->markIsolated(all);
+		this->measureTile(all);
+	}
+	{
+		PhaseClock clock(PT_SYNC);
+		this->refreshEdgeGhosts(-1, this->universeHeight + 1);
+		this->syncTile(all);
+	}
+	if (DEBUG && PRINT_UNIVERSE_ON_UPDATE) {
+		this->printUniverse();
+	}
+	PhaseClock clock(PT_MOVE);
+	this->claimTile(all);
+	this->moveTile(all);
+}
+
+Tile Universe::rowTile(int y) {
+	Tile row;
+	row.x0 = 0;
+	row.x1 = this->universeWidth;
+	row.y0 = y;
+	row.y1 = y + 1;
+	return row;
+}
+
+void Universe::updateFused() {
+	const int last = this->universeHeight - 1;
+	//the last row's pairs with the first row are measured from the first row's lanes,
+	//so both ends are measured before the sweep overwrites any lanes
+	this->markIsolated(this->rowTile(0));
+	this->markIsolated(this->rowTile(last));
+	this->measureTile(this->rowTile(0));
+	this->measureTile(this->rowTile(last));
+	this->refreshEdgeGhosts(-1, 0);
+	for (int y = 0; y <= last; y++) {
+		//measure one row ahead, the claims of row y reach into row y + 1
+		if (y + 1 < last) {
+			this->markIsolated(this->rowTile(y + 1));
+			this->measureTile(this->rowTile(y + 1));
+		}
+		this->refreshEdgeGhosts(y, y + 1);
+		this->syncTile(this->rowTile(y));
+		this->claimTile(this->rowTile(y));
+		//row y - 2 has every claim on the rows it can move into, and no later phase
+		//of this sweep reads rows y - 3 to y - 1 any more
+		if (y - 2 >= 2) {
+			this->moveTile(this->rowTile(y - 2));
+		}
+	}
+	//on a torus the first two rows move into cells the last row claims, so they move last
+	this->moveTile(this->rowTile(last - 1));
+	this->moveTile(this->rowTile(last));
+	this->moveTile(this->rowTile(0));
+	this->moveTile(this->rowTile(1));
+	this->refreshEdgeGhosts(last + 1, last + 2);
+}
+
+void Universe::setEngine(UpdateEngine engine, int threads) {
+	this->engine = engine;
+	delete this->pool;
+	this->pool = nullptr;
+	this->tiles.clear();
+	this->tileActiveAt.clear();
+	this->tileAwake.clear();
+	if (engine != UE_TILED) {
+		return;
+	}
+	this->pool = new ThreadPool(threads);
+	this->tileColumns = (universeWidth + TILE_SIZE - 1) / TILE_SIZE;
+	for (int y = 0; y < universeHeight; y += TILE_SIZE) {
+		for (int x = 0; x < universeWidth; x += TILE_SIZE) {
+			Tile tile;
+			tile.x0 = x;
+			tile.y0 = y;
+			tile.x1 = std::min(x + TILE_SIZE, universeWidth);
+			tile.y1 = std::min(y + TILE_SIZE, universeHeight);
+			this->tiles.push_back(tile);
+		}
+	}
+	//no tile knows what the other engines changed, so every tile starts out active
+	this->tileActiveAt.assign(this->tiles.size(), this->stepStamp(1));
+	this->tileAwake.assign(this->tiles.size(), 1);
+}
+
+UpdateEngine Universe::getEngine() {
+	return this->engine;
+}
+
+int Universe::threadCount() {
+	return this->pool ? this->pool->threadCount() : 1;
+}
+
+void Universe::setSimdLevel(SimdLevel level) {
+	this->kernels = &forceKernels(level);
+}
+
+SimdLevel Universe::getSimdLevel() {
+	return this->kernels->level;
+}
+
+void Universe::setIncremental(bool incremental) {
+	this->incremental = incremental;
+}
+
+bool Universe::getIncremental() {
+	return this->incremental;
+}
+
+void Universe::updateTiled() {
+	int tileCount = (int)this->tiles.size();
+	const uint8_t now = this->stepStamp();
+	//a tile only records its own activity, moves into a neighbor show up in the tile they came from
+	{
+		PhaseClock clock(PT_PRESSURE);
+		this->wakeTiles();
+		this->pool->run(tileCount, [this](int t) {
+			if (this->tileAwake[t]) {
+				this->markIsolated(this->tiles[t]);
+			}
+		});
+		this->pool->run(tileCount, [this, now](int t) {
+			if (this->tileAwake[t] && this->measureTile(this->tiles[t])) {
+				this->tileActiveAt[t] = now;
+			}
+		});
+	}
+	{
+		PhaseClock clock(PT_SYNC);
+		this->refreshEdgeGhosts(-1, this->universeHeight + 1);
+		this->pool->run(tileCount, [this, now](int t) {
+			if (this->tileAwake[t] && this->syncTile(this->tiles[t])) {
+				this->tileActiveAt[t] = now;
+			}
+		});
+	}
+	if (DEBUG && PRINT_UNIVERSE_ON_UPDATE) {
+		this->printUniverse();
+	}
+	PhaseClock clock(PT_MOVE);
+	this->pool->run(tileCount, [this](int t) {
+		if (this->tileAwake[t]) {
+			this->claimTile(this->tiles[t]);
+		}
+	});
+	this->pool->run(tileCount, [this, now](int t) {
+		if (this->tileAwake[t] && this->moveTile(this->tiles[t])) {
+			this->tileActiveAt[t] = now;
+		}
+	});
+}
+
+//a change reaches three cells out before a sleeping tile has to see it, the tiles next to it must cover that
+static_assert(TILE_SIZE >= 3, "tiles must be at least 3 cells wide for sleeping tiles to wake in time");
+
+void Universe::wakeTiles() {
+	const int columns = this->tileColumns;
+	const int rows = (int)this->tiles.size() / columns;
+	const uint8_t last = this->stepStamp(1);
+	for (int ty = 0; ty < rows; ty++) {
+		for (int tx = 0; tx < columns; tx++) {
+			const int t = ty * columns + tx;
+			const Tile& tile = this->tiles[t];
+			//the pairs of cells next to the border change with the boundary, a tile reading them never sleeps
+			bool awake = this->recomputeAll || tile.x0 < 2 || tile.y0 < 2
+				|| tile.x1 > this->universeWidth - 2 || tile.y1 > this->universeHeight - 2;
+			for (int dy = -1; dy <= 1 && !awake; dy++) {
+				for (int dx = -1; dx <= 1 && !awake; dx++) {
+					int ny = ty + dy;
+					int nx = tx + dx;
+					awake = ny >= 0 && ny < rows && nx >= 0 && nx < columns && this->tileActiveAt[ny * columns + nx] == last;
+				}
+			}
+			this->tileAwake[t] = awake;
+		}
+	}
+}
+
+int Universe::awakeTileCount() {
+	int awake = 0;
+	for (uint8_t a : this->tileAwake) {
+		awake += a;
+	}
+	return awake;
+}
+
+int Universe::tileCount() {
+	return (int)this->tiles.size();
+}
+
+void Universe::markIsolated(const Tile& tile) {
+	const int lastY = this->universeHeight - 1;
+	const int lastX = this->universeWidth - 1;
+	for (int y = tile.y0; y < tile.y1; y++) {
+		for (int x = tile.x0; x < tile.x1; x++) {
+			size_t self = this->space->index(y, x);
+			bool border = y == 0 || y == lastY || x == 0 || x == lastX;
+			//only a move next to the cell can give it a neighbor or take its last one
+			if (border || this->recomputeAll || this->movedNear(self)) {
+				this->isolated[self] = this->hasNoNeighbors(y, x);
+			}
+		}
+	}
+}
+
+force_t Universe::measurePair(size_t owner, size_t other, OFP ownerPos) {
+	if (this->isolated[owner]) {
+		return this->space->outerForce[ownerPos][owner];
+	}
+	return this->speciesTable.pairPressure(this->space->species[owner], this->space->species[other]);
+}
+
+void Universe::measureBorderCell(int y, int x) {
+	size_t self = this->space->index(y, x);
+	for (int e = 0; e < 4; e++) {
+		OFP myPos = edgePosition(e);
+		OFP otherPos = (OFP)((myPos + 4) % 8);
+		int otherY = y + OFP_Y[myPos];
+		int otherX = x + OFP_X[myPos];
+		size_t other;
+		if (this->inside(otherY, otherX)) {
+			other = this->space->index(otherY, otherX);
+		}
+		else if (this->boundary == BM_TORUS) {
+			other = this->space->index(this->wrapY(otherY), this->wrapX(otherX));
+		}
+		else {
+			//the cell inside owns its pair with a ghost
+			this->edges->edge[e][self] = this->measurePair(self, self + this->offset[myPos], myPos);
+			continue;
+		}
+		//only the pairs wrapping around the last row or column are owned by the other cell
+		if (self < other) {
+			this->edges->edge[e][self] = this->measurePair(self, other, myPos);
+		}
+		else {
+			this->edges->edge[e][self] = this->measurePair(other, self, otherPos);
+		}
+	}
+}
+
+bool Universe::measureTile(const Tile& tile) {
+	const int lastY = this->universeHeight - 1;
+	const int lastX = this->universeWidth - 1;
+	bool changed = false;
+	uint64_t bonds[4] = {}; //pairs measured by PairBond
+	for (int y = tile.y0; y < tile.y1; y++) {
+		for (int x = tile.x0; x < tile.x1; x++) {
+			size_t self = this->space->index(y, x);
+			this->claims[self].store(0, std::memory_order_relaxed);
+			bool border = y == 0 || y == lastY || x == 0 || x == lastX;
+			if (!border && !this->measureDirty(self)) {
+				continue; //every pair stored here would come out the same
+			}
+			force_t before[4];
+			for (int e = 0; e < 4; e++) {
+				before[e] = this->edges->edge[e][self];
+			}
+			if (border) {
+				this->measureBorderCell(y, x);
+			}
+			else {
+				//away from the border every pair a cell stores leads to a later cell, so the cell owns them all
+				for (int e = 0; e < 4; e++) {
+					OFP myPos = edgePosition(e);
+					this->edges->edge[e][self] = this->measurePair(self, self + this->offset[myPos], myPos);
+				}
+			}
+			changed |= this->stampEdges(self, before);
+			if (INSTRUMENT && !this->isolated[self]) {
+				for (int e = 0; e < 4; e++) {
+					SpeciesId other = this->space->species[self + this->offset[edgePosition(e)]];
+					bonds[this->speciesTable.pairBond(this->space->species[self], other)]++;
+				}
+			}
+		}
+	}
+	if (INSTRUMENT) {
+		instruments().count(EC_IONIC_PAIRS, bonds[PB_IONIC]);
+		instruments().count(EC_COVALENT_PAIRS, bonds[PB_COVALENT]);
+		instruments().count(EC_REPULSIVE_PAIRS, bonds[PB_REPULSIVE]);
+	}
+	return changed;
+}
+
+force_t Universe::cornerForce(int y, int x) {
+	//both members of a pair measured the same value, so a corner is two pairs counted twice
+	force_t pA = this->edges->edge[E_BOTR][this->space->index(y, x)];     //tl <-> br
+	force_t pB = this->edges->edge[E_BOTL][this->space->index(y, x + 1)]; //tr <-> bl
+	size_t tl = this->orderOf(y, x);
+	size_t br = this->orderOf(y + 1, x + 1);
+	size_t first = std::min(std::min(tl, this->orderOf(y, x + 1)), std::min(this->orderOf(y + 1, x), br));
+	force_t force;
+	if (first == tl || first == br) {
+		force = pA + pA + pB + pB;
+	}
+	else {
+		force = pB + pB + pA + pA;
+	}
+	return force / 4;
+}
+
+void Universe::syncCell(int y, int x) {
+	size_t n[8];
+	force_t** f = this->space->outerForce;
+	size_t self = this->space->index(y, x);
+	this->getNeighborsFor(y, x, n);
+	//both sides of an edge read the one stored pair force
+	force_t* const* e = this->edges->edge;
+	f[F_TOP][self] = e[E_BOT][n[F_TOP]];
+	f[F_RIGHT][self] = e[E_RIGHT][self];
+	f[F_BOT][self] = e[E_BOT][self];
+	f[F_LEFT][self] = e[E_RIGHT][n[F_LEFT]];
+	f[F_TOPL][self] = this->cornerForce(y - 1, x - 1);
+	f[F_TOPR][self] = this->cornerForce(y - 1, x);
+	f[F_BOTL][self] = this->cornerForce(y, x - 1);
+	f[F_BOTR][self] = this->cornerForce(y, x);
+}
+
+bool Universe::syncTile(const Tile& tile) {
+	const int lastY = this->universeHeight - 1;
+	const int lastX = this->universeWidth - 1;
+	bool synced = false;
+	for (int y = tile.y0; y < tile.y1; y++) {
+		if (y == 0 || y == lastY) {
+			//every corner of the first and last row touches the border
+			for (int x = tile.x0; x < tile.x1; x++) {
+				this->syncCell(y, x);
+			}
+			this->finishSync(y, tile.x0, tile.x1);
+			continue;
+		}
+		int x0 = std::max(tile.x0, 1);
+		int x1 = std::min(tile.x1, lastX);
+		if (tile.x0 == 0) {
+			this->syncCell(y, 0);
+			this->finishSync(y, 0, 1);
+		}
+		//neighboring cells that need a sync go through the kernels as one run
+		int x = x0;
+		while (x < x1) {
+			if (!this->syncDirty(this->space->index(y, x))) {
+				x++;
+				continue;
+			}
+			int end = x + 1;
+			while (end < x1 && this->syncDirty(this->space->index(y, end))) {
+				end++;
+			}
+			this->kernels->syncRow(this->edges->edge, this->space->outerForce, this->space->stride(),
+				this->space->index(y, x), this->space->index(y, end));
+			this->finishSync(y, x, end);
+			synced = true;
+			x = end;
+		}
+		if (tile.x1 > lastX) {
+			this->syncCell(y, lastX);
+			this->finishSync(y, lastX, lastX + 1);
+		}
+	}
+	return synced;
+}
+
+void Universe::finishSync(int y, int x0, int x1) {
+	//every lane of the run is final, the net force pass is folded in here
+	this->kernels->netForceRow(this->space->outerForce, this->space->index(y, x0),
+		this->space->index(y, x1), this->netForce.data());
+	memset(&this->lanesChangedAt[this->space->index(y, x0)], this->stepStamp(), (size_t)(x1 - x0));
+}
+
+bool Universe::moveTile(const Tile& tile) {
+	//a winner only writes its own cell and the empty cell it won, only one atom wins a cell
+	uint64_t outcomes[4] = {};
+	for (int y = tile.y0; y < tile.y1; y++) {
+		for (int x = tile.x0; x < tile.x1; x++) {
+			outcomes[this->moveAtoms(y, x)]++;
+		}
+	}
+	if (INSTRUMENT) {
+		instruments().count(EC_MOVES, outcomes[MO_MOVED]);
+		instruments().count(EC_BLOCKED_MOVES, outcomes[MO_BLOCKED]);
+		instruments().count(EC_FAILED_CLAIMS, outcomes[MO_OUTBID]);
+	}
+	return outcomes[MO_MOVED] != 0;
+}
+
+void Universe::claimTile(const Tile& tile) {
+	for (int y = tile.y0; y < tile.y1; y++) {
+		for (int x = tile.x0; x < tile.x1; x++) {
+			this->claimMove(y, x);
+		}
+	}
+}
+
+void Universe::printUniverse(std::ostream& out) {
+	using namespace std;
+	out << fixed << showpoint << setprecision(1);
+	for (int y = 0; y < universeHeight; y++) {
+		for (int yLevel = 0; yLevel < 3; yLevel++) {
+			for (int x = 0; x < universeWidth; x++) {
+				if (yLevel == 0) {
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_TOPL) << "|";
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_TOP) << "|";
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_TOPR) << "|";
+				}
+				else if (yLevel == 1) {
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_LEFT) << "|";
+					out << setw(6) << "X" << "|";
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_RIGHT) << "|";
+				}
+				else {
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_BOTL) << "|";
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_BOT) << "|";
+					out << setw(6) << this->space->outerForceAt(this->space->index(y, x), F_BOTR) << "|";
+				}
+			}
+			out << endl;
+		}
+		out << endl;
+	}
+}
+
+void Universe::writeState(std::ostream& out) {
+	out << universeWidth << " " << universeHeight << std::endl;
+	for (int y = 0; y < universeHeight; y++) {
+		for (int x = 0; x < universeWidth; x++) {
+			const Atom& atom = this->space->speciesAt(this->space->index(y, x));
+			if (x) {
+				out << " ";
+			}
+			out << atom.getProtons() << "," << atom.getNeutrons() << "," << atom.getElectrons();
+		}
+		out << std::endl;
+	}
+}
+
+bool Universe::saveCheckpoint(const std::string& path) {
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+	header.version = CHECKPOINT_VERSION;
+	header.byteOrder = CHECKPOINT_BYTE_ORDER;
+	header.forceBytes = sizeof(force_t);
+	header.boundary = this->boundary;
+	header.width = this->universeWidth;
+	header.height = this->universeHeight;
+	header.seed = this->seed;
+	header.step = this->stepCount;
+	header.speciesCount = this->speciesTable.count();
+	header.gridOffset = checkpointGridOffset(this->speciesTable.count());
+	header.gridBytes = this->space->memoryUsage();
+	std::vector<CheckpointSpecies> entries(this->speciesTable.count());
+	for (size_t id = 0; id < entries.size(); id++) {
+		const Atom& composition = this->speciesTable.atomOf((SpeciesId)id);
+		entries[id].protons = composition.getProtons();
+		entries[id].neutrons = composition.getNeutrons();
+		entries[id].electrons = composition.getElectrons();
+	}
+	const size_t written = sizeof(header) + entries.size() * sizeof(CheckpointSpecies);
+	std::vector<char> padding((size_t)header.gridOffset - written, 0);
+
+	//a universe opened from path may still be reading pages from it, so the old file is only replaced once the new one is complete
+	std::string temporary = path + ".tmp";
+	std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)entries.data(), entries.size() * sizeof(CheckpointSpecies));
+	out.write(padding.data(), padding.size());
+	out.write((const char*)this->space->storage(), header.gridBytes);
+	out.close();
+	if (!out) {
+		std::cerr << "Could not write checkpoint " << temporary << std::endl;
+		std::remove(temporary.c_str());
+		return false;
+	}
+	if (MAPPING_LOCKS_FILE && this->space->isMappedFrom(path)) {
+		//the grid still reads pages from the file it was opened from, it needs a copy of its own before that file can go
+		this->space->ownArrays();
+	}
+	if (!replaceFile(temporary, path)) {
+		std::cerr << "Could not replace checkpoint " << path << ", it is saved as " << temporary << std::endl;
+		return false;
+	}
+	return true;
+}
+
+Universe* Universe::openCheckpoint(const std::string& path) {
+	MappedFile* file = new MappedFile(path);
+	if (!file->isOpen()) {
+		std::cerr << "Could not open checkpoint " << path << std::endl;
+		delete file;
+		return nullptr;
+	}
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(&header, file->data(), std::min(sizeof(header), file->size()));
+	const char* problem = checkpointProblem(header, file->size());
+	Universe* universe = nullptr;
+	if (problem == nullptr) {
+		universe = new Universe();
+		universe->universeWidth = header.width;
+		universe->universeHeight = header.height;
+		universe->boundary = (BoundaryMode)header.boundary;
+		universe->seed = header.seed;
+		universe->stepCount = header.step;
+		//registering the species in id order hands them back the ids the grid refers to
+		const CheckpointSpecies* entries = (const CheckpointSpecies*)(file->data() + sizeof(CheckpointHeader));
+		for (uint64_t id = 1; id < header.speciesCount && problem == nullptr; id++) {
+			Atom composition(entries[id].protons, entries[id].neutrons, entries[id].electrons);
+			if (composition.isEmpty() || universe->speciesTable.idOf(composition) != id) {
+				problem = "damaged species table";
+			}
+		}
+	}
+	if (problem == nullptr) {
+		universe->space = new AtomGrid(universe->universeWidth, universe->universeHeight, &universe->speciesTable, file, (size_t)header.gridOffset);
+		file = nullptr; //the grid owns it now
+		//every lookup trusts the ids in the grid, one outside the table would read past it
+		const SpeciesId* species = universe->space->species;
+		for (size_t i = 0; i < universe->space->cells(); i++) {
+			if (species[i] >= header.speciesCount) {
+				problem = "damaged grid";
+				break;
+			}
+		}
+	}
+	if (problem != nullptr) {
+		std::cerr << "Could not open checkpoint " << path << ": " << problem << std::endl;
+		delete universe;
+		delete file;
+		return nullptr;
+	}
+	universe->prepareSpace();
+	return universe;
+}
+
+int Universe::width() {
+	return this->universeWidth;
+}
+
+int Universe::height() {
+	return this->universeHeight;
+}
+
+BoundaryMode Universe::getBoundary() {
+	return this->boundary;
+}
+
+uint64_t Universe::getSeed() {
+	return this->seed;
+}
+
+uint64_t Universe::getStep() {
+	return this->stepCount;
+}
+
+Atom Universe::atomAt(int y, int x) {
+	return this->space->atomAt(this->space->index(y, x));
+}
+
+void Universe::changedCells(std::vector<CellChange>& out) {
+	out.clear();
+	const uint8_t last = this->stepStamp(1);
+	for (int y = 0; y < universeHeight; y++) {
+		for (int x = 0; x < universeWidth; x++) {
+			size_t i = this->space->index(y, x);
+			if (this->movedAt[i] == last) {
+				CellChange change;
+				change.cell = (uint64_t)y * universeWidth + x;
+				change.species = this->space->species[i];
+				change.valence = this->space->valence[i];
+				out.push_back(change);
+			}
+		}
+	}
+}
+
+const SpeciesTable& Universe::getSpeciesTable() {
+	return this->speciesTable;
+}
+
+//lanes of an empty cell are whatever the last atom to leave it carried away, no update reads them
+uint64_t Universe::stateHash(bool lanes) {
+	//FNV-1a over whole values instead of bytes, finished like splitmix64 so nearby states spread out
+	const uint64_t prime = 0x100000001B3ULL;
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hash = (hash ^ (uint64_t)this->universeWidth) * prime;
+	hash = (hash ^ (uint64_t)this->universeHeight) * prime;
+	for (int y = 0; y < this->universeHeight; y++) {
+		for (int x = 0; x < this->universeWidth; x++) {
+			size_t i = this->space->index(y, x);
+			hash = (hash ^ ((uint64_t)this->space->species[i] << 8 | this->space->valence[i])) * prime;
+			if (!lanes || this->space->isEmpty(i)) {
+				continue;
+			}
+			for (int d = 0; d < 8; d++) {
+				uint64_t bits = 0;
+				memcpy(&bits, &this->space->outerForce[d][i], sizeof(force_t));
+				hash = (hash ^ bits) * prime;
+			}
+		}
+	}
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+bool Universe::firstDifference(Universe& other, double tolerance, StateDifference& out) {
+	if (this->universeWidth != other.universeWidth || this->universeHeight != other.universeHeight) {
+		out.y = out.x = -1;
+		out.what = "size";
+		out.mine = (double)this->universeWidth * this->universeHeight;
+		out.theirs = (double)other.universeWidth * other.universeHeight;
+		return true;
+	}
+	for (int y = 0; y < this->universeHeight; y++) {
+		for (int x = 0; x < this->universeWidth; x++) {
+			size_t i = this->space->index(y, x);
+			out.y = y;
+			out.x = x;
+			if (this->space->species[i] != other.space->species[i]) {
+				out.what = "species";
+				out.mine = this->space->species[i];
+				out.theirs = other.space->species[i];
+				return true;
+			}
+			if (this->space->valence[i] != other.space->valence[i]) {
+				out.what = "valence";
+				out.mine = this->space->valence[i];
+				out.theirs = other.space->valence[i];
+				return true;
+			}
+			if (this->space->isEmpty(i)) {
+				continue;
+			}
+			for (int d = 0; d < 8; d++) {
+				force_t mine = this->space->outerForce[d][i];
+				force_t theirs = other.space->outerForce[d][i];
+				bool same;
+				if (tolerance > 0) {
+					double scale = std::max(1.0, std::max(std::fabs((double)mine), std::fabs((double)theirs)));
+					same = std::fabs((double)mine - (double)theirs) <= tolerance * scale;
+				}
+				else {
+					same = memcmp(&mine, &theirs, sizeof(force_t)) == 0;
+				}
+				if (!same) {
+					const char* names[8] = { "top left lane", "top lane", "top right lane", "right lane",
+						"bottom right lane", "bottom lane", "bottom left lane", "left lane" };
+					out.what = names[d];
+					out.mine = mine;
+					out.theirs = theirs;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+void Universe::writeSnapshot(RenderSnapshot& out) {
+	out.width = this->universeWidth;
+	out.height = this->universeHeight;
+	out.step = this->stepCount;
+	out.cells.resize((size_t)this->universeWidth * this->universeHeight);
+	CellView* cell = out.cells.data();
+	for (int y = 0; y < universeHeight; y++) {
+		for (int x = 0; x < universeWidth; x++, cell++) {
+			size_t i = this->space->index(y, x);
+			const Atom& atom = this->space->speciesAt(i);
+			cell->protons = (uint16_t)atom.getProtons();
+			cell->neutrons = (uint16_t)atom.getNeutrons();
+			cell->species = this->space->species[i];
+			cell->valence = this->space->valence[i];
+		}
+	}
+}
+
+size_t Universe::memoryUsage() {
+	return this->space->memoryUsage() + this->edges->memoryUsage() + this->space->cells() * sizeof(std::atomic<uint64_t>)
+		+ this->isolated.capacity() * sizeof(uint8_t) + this->netForce.capacity() * sizeof(NetForce)
+		+ (this->movedAt.capacity() + this->edgesChangedAt.capacity() + this->lanesChangedAt.capacity()) * sizeof(uint8_t);
+}
+
+size_t Universe::memoryFor(int width, int height) {
+	size_t cells = (size_t)(width + 2) * (size_t)(height + 2);
+	return AtomGrid::memoryFor(width, height) + ForceEdges::memoryFor(cells)
+		+ cells * (sizeof(std::atomic<uint64_t>) + 4 * sizeof(uint8_t) + sizeof(NetForce)); //isolated and three change stamps
+}
@@ -0,0 +1,349 @@
+ #pragma once
+
+#include "Config.h"
+#include "AtomGrid.h"
+#include "ThreadPool.h"
+#include "ForceEdges.h"
+#include "ForceKernels.h"
+#include "CounterRandom.h"
+#include "RenderSnapshot.h"
+#include <atomic>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+/* Ways Universe::update can run a step, every engine produces the same universe
+* UE_SERIAL runs each phase over the whole grid on the calling thread and is the reference
+* UE_TILED splits the grid into tiles and runs each phase across a thread pool
+* UE_FUSED runs every phase in one sweep down the rows, each phase a few rows behind the one
+* before it, so a row is still in cache when the next phase reaches it
+*/
+typedef enum UpdateEngine { UE_SERIAL, UE_TILED, UE_FUSED } UpdateEngine;
+
+/* What lies beyond the edges of the universe, chosen when it is created
+* BM_TORUS wraps every side around to the opposite one
+* BM_OPEN surrounds the universe with empty space atoms cannot move into
+* BM_REFLECT surrounds it with a mirror image of the outermost atoms, they push against their own reflection
+*/
+typedef enum BoundaryMode { BM_TORUS, BM_OPEN, BM_REFLECT } BoundaryMode;
+
+/* What became of an atom in the move phase
+* MO_BLOCKED points at a wall or an atom, MO_OUTBID lost the cell it claimed to a stronger claim
+*/
+typedef enum MoveOutcome { MO_STAYED, MO_MOVED, MO_BLOCKED, MO_OUTBID } MoveOutcome;
+
+/* Cells [x0, x1) x [y0, y1) handled by one task of the tiled update
+* a tile only ever writes its own cells, the ring of cells around it (its halo)
+* is read but never written
+*/
+struct Tile {
+	int x0, y0, x1, y1;
+};
+
+/* A cell of the ghost border and the cell it repeats, NO_CELL when it stays blank
+*/
+struct Ghost {
+	int y, x;
+	size_t cell, source;
+};
+
+/* Contents of one cell after an update, cell counts row by row from the top left without the ghost border
+*/
+struct CellChange {
+	uint64_t cell;
+	SpeciesId species;
+	uint8_t valence;
+};
+
+/* First place two universes disagree, see Universe::firstDifference
+* what is "size", "species", "valence" or the OFP of a force lane
+*/
+struct StateDifference {
+	int y;
+	int x;
+	std::string what;
+	double mine;
+	double theirs;
+};
+
+/*
+* Defines the laws of the universe
+*
+* Manages a grid of atoms determining rules for how they interact.
+* Atoms move in two phases over the one grid: every atom heading for an empty cell claims it,
+* then the strongest claim of each cell moves in and the others stay put. Only the winner of
+* a cell writes it, so tiles can move their atoms at the same time and any thread count gives
+* the same universe.
+*
+* Every phase reads its neighbors through the grids' ghost border, the ghosts are refreshed
+* once after the phase that produces what the next one reads, so only the cells on the
+* border of the universe ever look at the boundary mode.
+*/
+class Universe {
+	int universeWidth;
+	int universeHeight;
+	BoundaryMode boundary;
+	uint64_t seed;      //every random choice is drawn from CounterRandom(seed, cell, step)
+	uint64_t stepCount; //updates completed
+	SpeciesTable speciesTable;
+	AtomGrid* space;
+
+	UpdateEngine engine;
+	ThreadPool* pool;
+	std::vector<Tile> tiles;
+	int tileColumns;                 //tiles along each row, tiles are stored row by row
+	std::vector<uint8_t> tileActiveAt; //low byte of the step a tile last moved an atom or changed a pair or lane
+	std::vector<uint8_t> tileAwake;    //1 for tiles that run this step, see wakeTiles
+	ForceEdges* edges;               //force of every pair of neighbors, measured before the sync
+	std::atomic<uint64_t>* claims;   //strongest claim on every empty cell, see claimPriority
+	std::vector<uint8_t> isolated;   //1 for cells with no neighbors
+	bool incremental;                //only recompute forces around cells that changed, see setIncremental
+	bool recomputeAll;               //this step recomputes every cell, until the caches hold a whole step
+	std::vector<uint8_t> movedAt;        //low byte of the step an atom last moved into or out of the cell
+	std::vector<uint8_t> edgesChangedAt; //low byte of the step one of the cell's pairs last changed
+	std::vector<uint8_t> lanesChangedAt; //low byte of the step the cell's lanes were last synced
+	std::vector<NetForce> netForce;  //net force of every cell in space, refreshed after the sync
+	const ForceKernels* kernels;     //row kernels for the sync and net force passes
+	ptrdiff_t offset[8];             //distance to the neighbor at each OFP
+	std::vector<Ghost> ghosts;       //every ghost cell row by row, sources depend on the boundary mode
+	std::vector<size_t> ghostRows;   //first ghost of each row, row y starts at ghostRows[y + 1]
+
+	/* Fills both grids with a random layout drawn from the seed
+	* each row is independent of the others so rows are generated in parallel
+	* @param cellsPerAtom one cell in this many draws an atom
+	*/
+	void createLayout(int cellsPerAtom);
+
+	/* Everything a universe needs around its grid once the grid holds the atoms:
+	* force edges, per cell scratch arrays and the ghost border
+	*/
+	void prepareSpace();
+
+	/* Brings a coordinate at most one cell outside the grid back in on the opposite side
+	*/
+	int wrapY(int y);
+	int wrapX(int x);
+
+	bool inside(int y, int x);
+
+	/* Cell that decides pair ownership and corner order for (y, x)
+	* on a torus a ghost stands for the cell it repeats, otherwise its own index is used
+	*/
+	size_t orderOf(int y, int x);
+
+	/* Cell indices of the 8 neighbors in OFP order, ghosts for neighbors beyond the border
+	*/
+	void getNeighborsFor(int y, int x, size_t neighbors[8]);
+
+	/* Copies every ghost from its source or blanks it
+	* @param mirror whether reflecting ghosts repeat this property, blanked when false
+	*/
+	template <typename T>
+	void refreshGhosts(T* cells, bool mirror);
+
+	/* Pair forces stored in the ghost cells of rows [y0, y1), read by the sync of the cells on the border
+	* rows go from -1 to height, on a torus the rows the ghosts repeat must be measured already
+	*/
+	void refreshEdgeGhosts(int y0, int y1);
+
+	/* Cell the net force of (y, x) points at, NO_CELL when it points nowhere or out of a walled universe
+	* @param direction set to the OFP of the move
+	*/
+	size_t moveTarget(int y, int x, OFP& direction);
+
+	/* Claim of the atom in self on the cell in direction, larger claims win
+	* the force towards the cell with the lowest bits telling the claiming atoms apart
+	*/
+	uint64_t claimPriority(size_t self, OFP direction);
+
+	/* First phase of a move, an atom heading for an empty cell claims it
+	*/
+	void claimMove(int y, int x);
+
+	/* Uses the forces calculated to take action, the atom moves into the cell it claimed if its claim won
+	* This function is critical for interesting changes to occur
+	* Changing the way this function works will highly affect the interactions
+	*/
+	MoveOutcome moveAtoms(int y, int x);
+
+	bool hasNoNeighbors(int y, int x);
+
+	/* Change tracking of the incremental update, stamps only keep the low byte of a step
+	* so a stamp left 256 steps ago reads as fresh, which only costs a needless recompute
+	*/
+	uint8_t stepStamp(int stepsAgo = 0);
+	bool movedNear(size_t self);   //an atom moved into or out of the 3x3 block around self last step
+	bool measureDirty(size_t self);
+	bool syncDirty(size_t self);
+	bool stampEdges(size_t self, const force_t before[4]); //true when a pair of self changed
+
+	void updateSerial();
+	void updateTiled();
+
+	/* Puts to sleep the tiles nothing can have changed for, every phase skips them
+	* a tile sleeps when neither it nor any tile around it was active the step before:
+	* a move reaches a cell's pairs two cells away and the sync one more, all inside the tiles around it,
+	* and whatever would run in a quiet tile comes out just as it is. Atoms that claim a cell always
+	* move somebody, so a quiet tile has no claims to redo. Tiles near the border stay awake
+	*/
+	void wakeTiles();
+
+	/* One sweep down the rows: a row is measured one row ahead of its sync and claims,
+	* and moves two rows behind once every claim on the rows around it is in
+	* needs at least 4 rows, smaller universes run the serial engine
+	*/
+	void updateFused();
+	Tile rowTile(int y);
+
+	/* The phases of an update, every cell of a tile only writes its own values
+	* so the tiles of a phase can run at the same time
+	* away from the border a phase skips the cells whose inputs did not change since the last step,
+	* each cell finds that out by reading the stamps around it rather than being told by its neighbors
+	* measure, sync and move return whether they changed anything the next step reads
+	*/
+	void markIsolated(const Tile& tile);
+
+	/* Measures the force of every pair a cell owns (see ForceEdges)
+	* the first of two atoms reached in scan order (the lower cell index) measures their pair,
+	* an isolated atom reuses its previous force instead (inertia)
+	* also clears the claims on the tile's cells left from the last move
+	*/
+	bool measureTile(const Tile& tile);
+	void measureBorderCell(int y, int x); //pairs of a cell next to the ghost border
+
+	/* Gathers the 8 synced outer forces of each cell from the pairs around it
+	* edges keep the measured pair force, corners average the two pairs crossing there,
+	* then works out the net force the move phase uses
+	*/
+	bool syncTile(const Tile& tile);
+	void syncCell(int y, int x); //sync of a cell next to the ghost border, the kernels handle the rest
+	void finishSync(int y, int x0, int x1); //net forces and lane stamps of the cells [x0, x1) just synced
+	void claimTile(const Tile& tile);
+	bool moveTile(const Tile& tile);
+
+	/* Force of a pair as measured by owner, the atom that reaches the pair first
+	* a single species table lookup unless the owner is isolated
+	*/
+	force_t measurePair(size_t owner, size_t other, OFP ownerPos);
+
+	/* Synced force at the corner point below and right of (y, x)
+	* the corner is averaged in the order the cell reached first in scan order would have used
+	*/
+	force_t cornerForce(int y, int x);
+public:
+	Universe();
+
+	/* @param width, height are the number of atoms along each side of the grid
+	* @param seed the layout is drawn from, the same seed always gives the same universe
+	* @param boundary what lies beyond the edges of the grid
+	* @param cellsPerAtom how sparse the layout is, one cell in this many draws an atom (1 fills every cell)
+	*/
+	Universe(int width, int height, uint64_t seed, BoundaryMode boundary = BM_TORUS, int cellsPerAtom = CELLS_PER_ATOM);
+
+	/* A square universe of size x size atoms
+	*/
+	Universe(int size, uint64_t seed, BoundaryMode boundary = BM_TORUS);
+
+	~Universe();
+
+	/* Called before other update functions
+	* currently does nothing but could be used to set initial values
+	* or moved to the end of the update cycle to make more calculations
+	*/
+	void update();
+
+	/* Choose how update runs
+	* @param threads used by UE_TILED, 0 uses every hardware thread
+	*/
+	void setEngine(UpdateEngine engine, int threads = 0);
+	UpdateEngine getEngine();
+	int threadCount();
+
+	/* Tiles of the tiled engine and how many of them ran the last update, the others were asleep
+	*/
+	int tileCount();
+	int awakeTileCount();
+
+	/* Instruction set used by the sync and net force kernels, the widest supported one by default
+	* every level gives the same universe, lower ones are there to compare against
+	*/
+	void setSimdLevel(SimdLevel level);
+	SimdLevel getSimdLevel();
+
+	/* Whether an update only measures and syncs the cells next to a change, on by default
+	* the pair forces and lanes everywhere else are kept from the step before, so a mostly settled
+	* universe updates much faster; the universe is the same either way
+	*/
+	void setIncremental(bool incremental);
+	bool getIncremental();
+
+	/* Prints Atoms as X's showing their measured force on all sides
+	 The size of this grid will be 3N X 3N due to showing neighboring outer force cells
+	*/
+	void printUniverse(std::ostream& out = std::cout);
+
+	/* Writes the protons/neutrons/electrons of every atom as text
+	* first line is the size of the universe, followed by one line per row of "p,n,e" cells
+	*/
+	void writeState(std::ostream& out);
+
+	/* Saves everything needed to carry on from this step as a binary checkpoint (see Checkpoint.h)
+	* the new file only replaces path once it is complete, a failed save leaves the old one alone
+	* must not run at the same time as update
+	* @return false when the file could not be written
+	*/
+	bool saveCheckpoint(const std::string& path);
+
+	/* A universe carrying on from the checkpoint at path, updating it gives the same steps the saved one would have
+	* the grid is mapped straight from the file instead of being read, the file itself is never written,
+	* nullptr when the file is not a checkpoint this build can open
+	*/
+	static Universe* openCheckpoint(const std::string& path);
+
+	int width();
+	int height();
+	BoundaryMode getBoundary();
+	uint64_t getSeed();
+	uint64_t getStep();
+
+	/* Read only access for front ends (display, analysis)
+	*/
+	Atom atomAt(int y, int x);
+
+	/* Every cell an atom moved into or out of during the last update, row by row, reusing out's memory
+	* a cell that last changed a multiple of 256 updates ago can show up as well, with the contents it still has
+	* must not run at the same time as update
+	*/
+	void changedCells(std::vector<CellChange>& out);
+
+	/* Composition of every species the grid refers to
+	*/
+	const SpeciesTable& getSpeciesTable();
+
+	/* Hash of everything a later update depends on: the species, valence shell and force lanes of every atom
+	* equal states always hash the same, firstDifference tells where two universes with different hashes part
+	* @param lanes false leaves the force lanes out, for comparisons that let them differ a little
+	*/
+	uint64_t stateHash(bool lanes = true);
+
+	/* First cell, row by row, where other differs from this universe
+	* @param tolerance how far force lanes may drift apart, relative to the larger of the two once it is above 1,
+	* 0 asks for the same bits
+	* @return false when they agree
+	*/
+	bool firstDifference(Universe& other, double tolerance, StateDifference& out);
+
+	/* Copies what a front end draws into out, reusing its memory
+	* must not run at the same time as update, front ends on another thread
+	* read the copy through a SnapshotExchange instead of the universe
+	*/
+	void writeSnapshot(RenderSnapshot& out);
+
+	/* Bytes held by the atom grid, force edges and per cell scratch arrays
+	*/
+	size_t memoryUsage();
+
+	/* Bytes a universe of width x height holds once created, it grows linearly with the cell count
+	*/
+	static size_t memoryFor(int width, int height);
+};
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include "Config.h"
+#include "Universe.h"
+#include "Trajectory.h"
+#include "Instrumentation.h"
+
+/*
+* Headless simulation driver
+*
+* Runs a universe with no window, audio or fonts so long batch simulations
+* can run at full speed on machines without a display.
+*
+* usage: ValenceHeadless [--size N] [--width N] [--height N] [--steps N] [--seed N] [--output FILE]
+*                        [--report N] [--engine serial|tiled|fused] [--threads N] [--simd scalar|sse2|avx|best]
+*                        [--boundary torus|open|reflect] [--recompute changed|all] [--cells-per-atom N]
+*                        [--resume FILE] [--checkpoint FILE] [--record FILE] [--keyframes N]
+*                        [--stats FILE] [--stats-every N]
+*        ValenceHeadless --replay FILE [--seek N] [--output FILE]
+*        ValenceHeadless --verify [--tolerance T] [--golden FILE] [--save-golden FILE] [layout and step options]
+*/
+
+struct HeadlessOptions {
+	int width = UNIVERSE_WIDTH;
+	int height = UNIVERSE_HEIGHT;
+	long long steps = 1000;
+	uint64_t seed = 0;
+	bool seeded = false;
+	std::string output;
+	long long report = 0; //print progress every N steps, 0 for never
+	UpdateEngine engine = UE_SERIAL;
+	int threads = 0;
+	SimdLevel simd = SIMD_BEST;
+	BoundaryMode boundary = BM_TORUS;
+	int cellsPerAtom = CELLS_PER_ATOM;
+	bool incremental = true;
+	std::string resume;     //checkpoint to carry on from instead of creating a universe
+	std::string checkpoint; //checkpoint written after the last step
+	std::string record;     //trajectory of every step
+	int keyframes = KEYFRAME_INTERVAL;
+	std::string replay;     //trajectory played back instead of running a universe
+	long long seek = -1;    //step the replay stops at, -1 for its last one
+	std::string stats;      //phase timers and event counters, JSON lines when it ends in .json and CSV otherwise
+	long long statsEvery = 0; //steps between lines of stats, 0 for only after the last step
+	bool verify = false;      //run every engine against the reference instead of one universe
+	double tolerance = 0;     //how far force lanes may drift apart while verifying, 0 for the same bits
+	std::string golden;       //hashes the reference has to match while verifying
+	std::string saveGolden;   //hashes of the reference written while verifying
+};
+
+static void printUsage(const char* program) {
+	std::cout << "usage: " << program << " [options]" << std::endl;
+	std::cout << "  --size N      atoms along each side of a square universe" << std::endl;
+	std::cout << "  --width N     atoms along each row (default " << UNIVERSE_WIDTH << ")" << std::endl;
+	std::cout << "  --height N    rows of atoms (default " << UNIVERSE_HEIGHT << ")" << std::endl;
+	std::cout << "  --steps N     number of updates to run (default 1000)" << std::endl;
+	std::cout << "  --seed N      seed for the universe layout (default: current time)" << std::endl;
+	std::cout << "  --output FILE write the final state of every atom to FILE" << std::endl;
+	std::cout << "  --report N    print progress every N steps" << std::endl;
+	std::cout << "  --engine E    serial (default), tiled or fused" << std::endl;
+	std::cout << "  --threads N   threads for the tiled engine (default: all hardware threads)" << std::endl;
+	std::cout << "  --simd S      scalar, sse2, avx or best (default) for the force kernels" << std::endl;
+	std::cout << "  --boundary B  torus (default), open or reflect" << std::endl;
+	std::cout << "  --recompute R changed (default) only recomputes forces next to moved atoms, all every force" << std::endl;
+	std::cout << "  --cells-per-atom N one cell in N draws an atom in the layout (default " << CELLS_PER_ATOM << ")" << std::endl;
+	std::cout << "  --resume FILE carry on from a checkpoint, its size, seed and boundary replace the options" << std::endl;
+	std::cout << "  --checkpoint FILE save a checkpoint after the last step" << std::endl;
+	std::cout << "  --record FILE record a trajectory of every step" << std::endl;
+	std::cout << "  --keyframes N steps between full frames of the trajectory (default " << KEYFRAME_INTERVAL << ")" << std::endl;
+	std::cout << "  --replay FILE play a trajectory back instead of running a universe, --output writes its last frame" << std::endl;
+	std::cout << "  --seek N      step the replay stops at (default: the last one recorded)" << std::endl;
+	std::cout << "  --verify      run the layout under every engine, recompute mode and a few thread counts next to" << std::endl;
+	std::cout << "                the serial reference and report the first step and cell where one parts from it" << std::endl;
+	std::cout << "  --tolerance T let force lanes differ by T relative to their size above 1 while verifying (default 0, same bits)" << std::endl;
+	std::cout << "  --golden FILE check the reference against hashes saved by an earlier --verify" << std::endl;
+	std::cout << "  --save-golden FILE save the reference's hash after every step" << std::endl;
+	std::cout << "  --stats FILE  write phase times and event counts to FILE, JSON lines for a .json file and CSV otherwise" << std::endl;
+	std::cout << "  --stats-every N add a line of stats every N steps, totals since the start (default: only after the last step)" << std::endl;
+}
+
+static bool parseOptions(int argc, char** argv, HeadlessOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--help" || arg == "-h") {
+			return false;
+		}
+		if (arg == "--verify") {
+			options.verify = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+		try {
+			if (arg == "--size") {
+				options.width = options.height = std::stoi(value);
+			}
+			else if (arg == "--width") {
+				options.width = std::stoi(value);
+			}
+			else if (arg == "--height") {
+				options.height = std::stoi(value);
+			}
+			else if (arg == "--steps") {
+				options.steps = std::stoll(value);
+			}
+			else if (arg == "--seed") {
+				options.seed = std::stoull(value);
+				options.seeded = true;
+			}
+			else if (arg == "--output") {
+				options.output = value;
+			}
+			else if (arg == "--resume") {
+				options.resume = value;
+			}
+			else if (arg == "--checkpoint") {
+				options.checkpoint = value;
+			}
+			else if (arg == "--record") {
+				options.record = value;
+			}
+			else if (arg == "--keyframes") {
+				options.keyframes = std::stoi(value);
+			}
+			else if (arg == "--replay") {
+				options.replay = value;
+			}
+			else if (arg == "--seek") {
+				options.seek = std::stoll(value);
+			}
+			else if (arg == "--cells-per-atom") {
+				options.cellsPerAtom = std::stoi(value);
+			}
+			else if (arg == "--tolerance") {
+				options.tolerance = std::stod(value);
+			}
+			else if (arg == "--golden") {
+				options.golden = value;
+			}
+			else if (arg == "--save-golden") {
+				options.saveGolden = value;
+			}
+			else if (arg == "--stats") {
+				options.stats = value;
+			}
+			else if (arg == "--stats-every") {
+				options.statsEvery = std::stoll(value);
+			}
+			else if (arg == "--report") {
+				options.report = std::stoll(value);
+			}
+			else if (arg == "--engine") {
+				if (value == "serial") {
+					options.engine = UE_SERIAL;
+				}
+				else if (value == "tiled") {
+					options.engine = UE_TILED;
+				}
+				else if (value == "fused") {
+					options.engine = UE_FUSED;
+				}
+				else {
+					std::cerr << "unknown engine " << value << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--threads") {
+				options.threads = std::stoi(value);
+			}
+			else if (arg == "--simd") {
+				SimdLevel levels[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX, SIMD_BEST };
+				bool found = false;
+				for (SimdLevel level : levels) {
+					if (value == simdLevelName(level)) {
+						options.simd = level;
+						found = true;
+					}
+				}
+				if (!found) {
+					std::cerr << "unknown instruction set " << value << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--boundary") {
+				if (value == "torus") {
+					options.boundary = BM_TORUS;
+				}
+				else if (value == "open") {
+					options.boundary = BM_OPEN;
+				}
+				else if (value == "reflect") {
+					options.boundary = BM_REFLECT;
+				}
+				else {
+					std::cerr << "unknown boundary " << value << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--recompute") {
+				if (value == "changed") {
+					options.incremental = true;
+				}
+				else if (value == "all") {
+					options.incremental = false;
+				}
+				else {
+					std::cerr << "unknown recompute mode " << value << std::endl;
+					return false;
+				}
+			}
+			else {
+				std::cerr << "unknown option " << arg << std::endl;
+				return false;
+			}
+		}
+		catch (const std::exception&) {
+			std::cerr << "invalid value for " << arg << ": " << value << std::endl;
+			return false;
+		}
+	}
+	if (options.width < 1 || options.height < 1 || options.cellsPerAtom < 1 || options.steps < 0 || options.statsEvery < 0
+		|| options.tolerance < 0) {
+		std::cerr << "width, height and cells-per-atom must be at least 1, steps, stats-every and tolerance cannot be negative" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static void writeStats(std::ostream& out, bool json, uint64_t step) {
+	if (json) {
+		Instrumentation::writeJson(out, step, instruments().sample());
+	}
+	else {
+		Instrumentation::writeCsv(out, step, instruments().sample());
+	}
+}
+
+static int replay(const HeadlessOptions& options) {
+	TrajectoryReader reader(options.replay);
+	if (!reader.isOpen()) {
+		return 1;
+	}
+	uint64_t last = options.seek < 0 ? reader.lastStep() : (uint64_t)options.seek;
+	std::cout << "replaying " << options.replay << " size: " << reader.width() << "x" << reader.height()
+		<< " steps: " << reader.firstStep() << " to " << reader.lastStep() << " seed: " << reader.getSeed() << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	long long frames = 0;
+	//step through every frame like a consumer would, seeking is only needed to start late
+	while (reader.getStep() < last && reader.step()) {
+		frames++;
+	}
+	if (reader.getStep() != last && !reader.seek(last)) {
+		std::cerr << "step " << last << " was not recorded" << std::endl;
+		return 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Replayed " << frames << " frames in " << seconds << "s";
+	if (seconds > 0) {
+		std::cout << " (" << frames / seconds << " frames/s)";
+	}
+	std::cout << std::endl;
+	if (!options.output.empty()) {
+		std::ofstream out(options.output);
+		if (!out) {
+			std::cerr << "could not open " << options.output << std::endl;
+			return 1;
+		}
+		reader.writeState(out);
+	}
+	return 0;
+}
+
+/* One way of running the universe checked against the reference
+*/
+struct VerifyVariant {
+	std::string name;
+	Universe* universe;
+	bool parted; //stopped at the first difference
+};
+
+static VerifyVariant makeVariant(const HeadlessOptions& options, UpdateEngine engine, int threads, bool incremental) {
+	VerifyVariant variant;
+	variant.universe = new Universe(options.width, options.height, options.seed, options.boundary, options.cellsPerAtom);
+	variant.universe->setEngine(engine, threads);
+	variant.universe->setSimdLevel(options.simd);
+	variant.universe->setIncremental(incremental);
+	variant.name = engine == UE_TILED ? "tiled" : engine == UE_FUSED ? "fused" : "serial";
+	if (engine == UE_TILED) {
+		variant.name += " threads " + std::to_string(variant.universe->threadCount());
+	}
+	variant.name += std::string(incremental ? " recompute changed" : " recompute all") + " simd "
+		+ simdLevelName(variant.universe->getSimdLevel());
+	variant.parted = false;
+	return variant;
+}
+
+/* Runs the layout under every engine next to the serial scalar update that recomputes every force,
+* hashing each universe after every step. The first time a hash differs from the reference the two
+* universes are compared cell by cell, the variant reports where and stops.
+*/
+static int verify(const HeadlessOptions& options) {
+	const uint32_t GOLDEN_VERSION = 1;
+	std::cout << "verifying size: " << options.width << "x" << options.height << " steps: " << options.steps << " seed: " << options.seed;
+	if (options.tolerance > 0) {
+		std::cout << " lane tolerance: " << options.tolerance;
+	}
+	std::cout << std::endl;
+	//lanes that barely differ have to print differently
+	std::cout << std::setprecision(17);
+	Universe reference(options.width, options.height, options.seed, options.boundary, options.cellsPerAtom);
+	reference.setSimdLevel(SIMD_SCALAR);
+	reference.setIncremental(false);
+
+	std::vector<VerifyVariant> variants;
+	for (bool incremental : { true, false }) {
+		variants.push_back(makeVariant(options, UE_SERIAL, 1, incremental));
+		variants.push_back(makeVariant(options, UE_FUSED, 1, incremental));
+	}
+	//every hardware thread the way ThreadPool counts them, on a small machine that can be 1 or 2 already
+	int hardware = (int)std::thread::hardware_concurrency();
+	if (hardware <= 0) {
+		hardware = 1;
+	}
+	std::vector<int> threadCounts;
+	for (int threads : { 1, 2, hardware, options.threads }) {
+		if (threads > 0 && std::find(threadCounts.begin(), threadCounts.end(), threads) == threadCounts.end()) {
+			threadCounts.push_back(threads);
+		}
+	}
+	for (int threads : threadCounts) {
+		variants.push_back(makeVariant(options, UE_TILED, threads, true));
+	}
+	variants.push_back(makeVariant(options, UE_TILED, hardware, false));
+
+	//a golden file is the layout's description followed by the reference's hashes after every step
+	std::ifstream golden;
+	if (!options.golden.empty()) {
+		golden.open(options.golden);
+		uint32_t version = 0;
+		int width = 0, height = 0, boundary = -1, cellsPerAtom = 0;
+		size_t forceBytes = 0;
+		uint64_t seed = 0;
+		std::string magic;
+		golden >> magic >> version >> width >> height >> seed >> boundary >> cellsPerAtom >> forceBytes;
+		if (!golden || magic != "valence-golden" || version != GOLDEN_VERSION) {
+			std::cerr << "could not read " << options.golden << std::endl;
+			return 1;
+		}
+		if (width != options.width || height != options.height || seed != options.seed || boundary != (int)options.boundary
+			|| cellsPerAtom != options.cellsPerAtom || forceBytes != sizeof(force_t)) {
+			std::cerr << options.golden << " was saved for another layout or a build with other forces" << std::endl;
+			return 1;
+		}
+	}
+	std::ofstream saved;
+	if (!options.saveGolden.empty()) {
+		saved.open(options.saveGolden);
+		if (!saved) {
+			std::cerr << "could not open " << options.saveGolden << std::endl;
+			return 1;
+		}
+		saved << "valence-golden " << GOLDEN_VERSION << "\n" << options.width << " " << options.height << " " << options.seed << " "
+			<< (int)options.boundary << " " << options.cellsPerAtom << " " << sizeof(force_t) << "\n";
+	}
+
+	//with a tolerance the lanes are compared cell by cell, the hash only covers what has to match exactly
+	const bool lanes = options.tolerance == 0;
+	bool goldenParted = false;
+	int parted = 0;
+	for (long long step = 0; step <= options.steps; step++) {
+		if (step > 0) {
+			reference.update();
+		}
+		uint64_t hash = reference.stateHash(lanes);
+		if (saved.is_open()) {
+			saved << std::dec << step << " " << std::hex << reference.stateHash(true) << " " << reference.stateHash(false) << "\n";
+		}
+		if (golden.is_open() && !goldenParted) {
+			long long goldenStep = -1;
+			uint64_t full = 0, withoutLanes = 0;
+			golden >> std::dec >> goldenStep >> std::hex >> full >> withoutLanes;
+			if (!golden || goldenStep != step) {
+				std::cout << options.golden << " ends before step " << step << std::endl;
+				goldenParted = true;
+				parted++; //a short file checked fewer steps than asked for
+			}
+			else if ((lanes ? full : withoutLanes) != hash) {
+				//a hash cannot tell where, only that the reference changed since the file was saved
+				std::cout << "reference parts from " << options.golden << " at step " << step << std::endl;
+				goldenParted = true;
+				parted++;
+			}
+		}
+		for (VerifyVariant& variant : variants) {
+			if (variant.parted) {
+				continue;
+			}
+			if (step > 0) {
+				variant.universe->update();
+			}
+			StateDifference difference;
+			bool differs = variant.universe->stateHash(lanes) != hash;
+			if (differs || !lanes) {
+				differs = variant.universe->firstDifference(reference, options.tolerance, difference);
+			}
+			if (differs) {
+				std::cout << variant.name << " parts at step " << step << " cell (" << difference.x << ", " << difference.y << ") "
+					<< difference.what << ": " << difference.mine << " instead of " << difference.theirs << std::endl;
+				variant.parted = true;
+				parted++;
+				//its universe is not needed any more
+				delete variant.universe;
+				variant.universe = nullptr;
+			}
+		}
+		if (options.report && step % options.report == 0) {
+			std::cout << "step " << step << " hash " << std::hex << hash << std::dec << std::endl;
+		}
+	}
+	for (VerifyVariant& variant : variants) {
+		if (!variant.parted) {
+			std::cout << variant.name << " matches through step " << options.steps << std::endl;
+			delete variant.universe;
+		}
+	}
+	int result = parted ? 1 : 0;
+	if (saved.is_open()) {
+		saved.close();
+		if (!saved) {
+			std::cerr << "could not write " << options.saveGolden << std::endl;
+			result = 1;
+		}
+	}
+	std::cout << (parted ? "FAILED" : "PASSED") << std::endl;
+	return result;
+}
+
+int main(int argc, char** argv) {
+	HeadlessOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (!options.replay.empty()) {
+		return replay(options);
+	}
+	if (!options.seeded) {
+		options.seed = randomSeed();
+	}
+	if (options.verify) {
+		return verify(options);
+	}
+	Universe* universe;
+	auto created = std::chrono::steady_clock::now();
+	if (!options.resume.empty()) {
+		universe = Universe::openCheckpoint(options.resume);
+		if (universe == nullptr) {
+			return 1;
+		}
+		std::cout << "resumed " << options.resume << " at step " << universe->getStep() << " size: " << universe->width() << "x"
+			<< universe->height() << " steps: " << options.steps << " seed: " << universe->getSeed() << std::endl;
+		std::cout << "opened in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - created).count() << "s" << std::endl;
+	}
+	else {
+		std::cout << "size: " << options.width << "x" << options.height << " steps: " << options.steps << " seed: " << options.seed << std::endl;
+		std::cout << "memory: " << Universe::memoryFor(options.width, options.height) / (1024 * 1024) << " MB";
+		std::cout << " forces: " << (sizeof(force_t) == sizeof(float) ? "float" : "double") << std::endl;
+		universe = new Universe(options.width, options.height, options.seed, options.boundary, options.cellsPerAtom);
+		std::cout << "created in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - created).count() << "s" << std::endl;
+	}
+	universe->setEngine(options.engine, options.threads);
+	universe->setSimdLevel(options.simd);
+	universe->setIncremental(options.incremental);
+	std::cout << "threads: " << universe->threadCount() << " simd: " << simdLevelName(universe->getSimdLevel()) << std::endl;
+	TrajectoryWriter* recording = nullptr;
+	if (!options.record.empty()) {
+		recording = new TrajectoryWriter(options.record, *universe, options.keyframes);
+		if (!recording->isOpen()) {
+			delete recording;
+			delete universe;
+			return 1;
+		}
+		recording->record(*universe);
+	}
+	std::ofstream stats;
+	bool statsJson = options.stats.size() >= 5 && options.stats.compare(options.stats.size() - 5, 5, ".json") == 0;
+	if (!options.stats.empty()) {
+		stats.open(options.stats);
+		if (!stats) {
+			std::cerr << "could not open " << options.stats << std::endl;
+			delete recording;
+			delete universe;
+			return 1;
+		}
+		if (!statsJson) {
+			Instrumentation::writeCsvHeader(stats);
+		}
+		if (!INSTRUMENT) {
+			std::cerr << "instruments are compiled out, every stat stays at 0" << std::endl;
+		}
+	}
+	//creating, opening and recording the universe is left out of the stats
+	instruments().reset();
+	auto start = std::chrono::steady_clock::now();
+	for (long long step = 1; step <= options.steps; step++) {
+		universe->update();
+		if (recording) {
+			recording->record(*universe);
+		}
+		if (stats.is_open() && options.statsEvery && step % options.statsEvery == 0 && step != options.steps) {
+			writeStats(stats, statsJson, universe->getStep());
+		}
+		if (options.report && step % options.report == 0) {
+			std::cout << "step " << step;
+			if (universe->getEngine() == UE_TILED) {
+				std::cout << " awake tiles: " << universe->awakeTileCount() << "/" << universe->tileCount();
+			}
+			std::cout << std::endl;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Total Updates: " << options.steps << " in " << seconds << "s";
+	if (seconds > 0) {
+		std::cout << " (" << options.steps / seconds << " updates/s)";
+	}
+	std::cout << std::endl;
+
+	int result = 0;
+	if (stats.is_open()) {
+		writeStats(stats, statsJson, universe->getStep());
+		stats.close();
+		if (!stats) {
+			std::cerr << "could not write " << options.stats << std::endl;
+			result = 1;
+		}
+	}
+	if (recording) {
+		//the steps still queued are written before the run counts as done
+		if (!recording->close()) {
+			result = 1;
+		}
+		delete recording;
+	}
+	if (!options.output.empty()) {
+		std::ofstream out(options.output);
+		if (!out) {
+			std::cerr << "could not open " << options.output << std::endl;
+			result = 1;
+		}
+		else {
+			universe->writeState(out);
+		}
+	}
+	if (!options.checkpoint.empty()) {
+		auto saving = std::chrono::steady_clock::now();
+		if (universe->saveCheckpoint(options.checkpoint)) {
+			std::cout << "checkpoint saved in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - saving).count() << "s" << std::endl;
+		}
+		else {
+			result = 1;
+		}
+	}
+	delete universe;
+	return result;
+}